@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+
+/*
+ * A counter for many threads that increment often, but read rarely.
+ *
+ * With a single std::atomic<int>, all threads fight for the same cache line, which moves
+ * from core to core on every increment. Here, the count is split over several slots, each
+ * on its own cache line. Every thread increments "its" slot with a relaxed atomic
+ * operation, so threads normally don't share any cache line. Reading adds up all slots.
+ *
+ * The value read is exact once all increments are finished. While threads are still
+ * incrementing, it is a recent value, but not a snapshot of one instant.
+ */
+class ShardedCounter {
+  // One slot per cache line, to avoid false sharing
+  struct alignas(64) Slot {
+    std::atomic<long> value{0};
+  };
+
+public:
+  explicit ShardedCounter(unsigned int nShards = 2 * std::thread::hardware_concurrency())
+    : m_nShards(nShards == 0 ? 1 : nShards), m_slots(std::make_unique<Slot[]>(m_nShards)) { }
+
+  void increment(long n = 1) {
+    m_slots[threadIndex() % m_nShards].value.fetch_add(n, std::memory_order_relaxed);
+  }
+
+  ShardedCounter& operator++() {
+    increment();
+    return *this;
+  }
+
+  long value() const {
+    long sum = 0;
+    for (unsigned int i = 0; i < m_nShards; ++i) {
+      sum += m_slots[i].value.load(std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+private:
+  // Every thread gets a number when it first uses any ShardedCounter
+  static unsigned int threadIndex() {
+    static std::atomic<unsigned int> nextIndex{0};
+    thread_local const unsigned int index = nextIndex++;
+    return index;
+  }
+
+  unsigned int m_nShards;
+  std::unique_ptr<Slot[]> m_slots;
+};
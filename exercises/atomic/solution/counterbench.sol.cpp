@@ -0,0 +1,75 @@
+#include "ShardedCounter.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Like in racing and atomic, many threads increment one counter.
+ * We compare three counters:
+ * - an int protected by a std::mutex
+ * - a std::atomic<int>
+ * - a ShardedCounter
+ * for 1, 2, 4, ... 64 threads (or the maximum given as argument), and print the
+ * number of increments per second.
+ */
+
+constexpr unsigned int nIncrements = 1 << 24;
+
+class MutexCounter {
+public:
+  void increment() {
+    std::scoped_lock lock{m_mutex};
+    ++m_value;
+  }
+  int value() const { return m_value; }
+
+private:
+  std::mutex m_mutex;
+  int m_value = 0;
+};
+
+class AtomicCounter {
+public:
+  void increment() { ++m_value; }
+  int value() const { return m_value; }
+
+private:
+  std::atomic<int> m_value{0};
+};
+
+template<typename Counter>
+double incrementsPerSecond(unsigned int nThreads) {
+  Counter counter;
+  const unsigned int perThread = nIncrements / nThreads;
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (unsigned int i = 0; i < nThreads; ++i) {
+    threads.emplace_back([&counter, perThread](){
+      for (unsigned int j = 0; j < perThread; ++j) {
+        counter.increment();
+      }
+    });
+  }
+  for (auto & thread : threads) thread.join();
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  if (counter.value() != static_cast<long>(perThread) * nThreads) {
+    std::cerr << "Race: " << counter.value() << '\n';
+  }
+  return perThread * nThreads / elapsed.count();
+}
+
+int main(int argc, char* argv[]) {
+  const unsigned int maxThreads = argc > 1 ? std::atoi(argv[1]) : 64;
+  std::cout << "threads\tmutex [1/s]\tatomic [1/s]\tsharded [1/s]\n";
+  for (unsigned int n = 1; n <= maxThreads; n *= 2) {
+    std::cout << n << '\t' << incrementsPerSecond<MutexCounter>(n)
+              << '\t' << incrementsPerSecond<AtomicCounter>(n)
+              << '\t' << incrementsPerSecond<ShardedCounter>(n) << '\n';
+  }
+}
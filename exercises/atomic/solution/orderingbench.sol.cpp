@@ -0,0 +1,100 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * The increment kernel of atomic.sol.cpp, with different memory orderings and layouts.
+ * For 1, 2, 4, ... 64 threads (or the maximum given as argument), we measure:
+ * - a++ on one shared counter with fetch_add(relaxed), fetch_add(acq_rel) and
+ *   fetch_add(seq_cst) (which is what a++ does)
+ * - a++ written as a compare-and-swap loop
+ * - one counter per thread, packed next to each other (false sharing) or each
+ *   on its own cache line (padded)
+ * and print the number of increments per second.
+ *
+ * Note that on x86, all read-modify-write operations are full barriers, so the three
+ * orderings of fetch_add often perform the same. They differ on e.g. ARM.
+ */
+
+constexpr unsigned int nIncrements = 1 << 24;
+
+struct PaddedCounter {
+  alignas(64) std::atomic<int> value{0};
+};
+
+// Runs kernel(threadIndex, nIterations) on nThreads threads, and returns increments per second
+template<typename Kernel>
+double incrementsPerSecond(unsigned int nThreads, Kernel kernel) {
+  const unsigned int perThread = nIncrements / nThreads;
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (unsigned int i = 0; i < nThreads; ++i) {
+    threads.emplace_back(kernel, i, perThread);
+  }
+  for (auto & thread : threads) thread.join();
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return perThread * nThreads / elapsed.count();
+}
+
+template<std::memory_order order>
+double sharedFetchAdd(unsigned int nThreads) {
+  std::atomic<int> a{0};
+  return incrementsPerSecond(nThreads, [&a](unsigned int, unsigned int n){
+    for (unsigned int i = 0; i < n; ++i) {
+      a.fetch_add(1, order);
+    }
+  });
+}
+
+double sharedCompareExchange(unsigned int nThreads) {
+  std::atomic<int> a{0};
+  return incrementsPerSecond(nThreads, [&a](unsigned int, unsigned int n){
+    for (unsigned int i = 0; i < n; ++i) {
+      int expected = a.load(std::memory_order_relaxed);
+      // On failure, expected is updated with the current value, and we try again
+      while (!a.compare_exchange_weak(expected, expected + 1, std::memory_order_relaxed)) { }
+    }
+  });
+}
+
+double falseSharing(unsigned int nThreads) {
+  auto counters = std::make_unique<std::atomic<int>[]>(nThreads);
+  return incrementsPerSecond(nThreads, [&counters](unsigned int index, unsigned int n){
+    for (unsigned int i = 0; i < n; ++i) {
+      counters[index].fetch_add(1, std::memory_order_relaxed);
+    }
+  });
+}
+
+double padded(unsigned int nThreads) {
+  auto counters = std::make_unique<PaddedCounter[]>(nThreads);
+  return incrementsPerSecond(nThreads, [&counters](unsigned int index, unsigned int n){
+    for (unsigned int i = 0; i < n; ++i) {
+      counters[index].value.fetch_add(1, std::memory_order_relaxed);
+    }
+  });
+}
+
+int main(int argc, char* argv[]) {
+  const unsigned int maxThreads = argc > 1 ? std::atoi(argv[1]) : 64;
+  const std::string columns[] = {"threads", "relaxed", "acq_rel", "seq_cst", "CAS loop",
+                                 "false sharing", "padded"};
+  std::cout << "Increments per second\n";
+  for (const auto & column : columns) std::cout << std::setw(14) << column;
+  std::cout << '\n' << std::scientific << std::setprecision(3);
+  for (unsigned int n = 1; n <= maxThreads; n *= 2) {
+    std::cout << std::setw(14) << n
+              << std::setw(14) << sharedFetchAdd<std::memory_order_relaxed>(n)
+              << std::setw(14) << sharedFetchAdd<std::memory_order_acq_rel>(n)
+              << std::setw(14) << sharedFetchAdd<std::memory_order_seq_cst>(n)
+              << std::setw(14) << sharedCompareExchange(n)
+              << std::setw(14) << falseSharing(n)
+              << std::setw(14) << padded(n) << '\n';
+  }
+}
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * Exact Fibonacci numbers, F(0) = 0, F(1) = 1, F(n) = F(n-1) + F(n-2).
+ * Note that fibo(n) in fibocrunch.cpp starts with fibo(0) = 1, so fibo(n) == F(n+1).
+ *
+ * - fibonacciTable(n):        compile-time table, n <= 93 (the largest that fits in 64 bits)
+ * - fibonacciFastDoubling(n): O(log n) fast doubling on uint64_t, empty if it overflows
+ * - fibonacciBig(n):          O(log n) fast doubling on arbitrary-precision integers
+ * - fibonacci(n, algorithm):  one entry point for all of the above
+ *
+ * Fast doubling uses F(2k)   = F(k) * (2 F(k+1) - F(k))
+ *                   F(2k+1) = F(k)^2 + F(k+1)^2
+ */
+
+// Largest n such that F(n) fits in a uint64_t
+constexpr unsigned int maxFibonacci64 = 93;
+
+namespace fibonacci_detail {
+    constexpr auto makeTable() {
+        std::array<std::uint64_t, maxFibonacci64 + 1> table{};
+        table[1] = 1;
+        for (std::size_t i = 2; i < table.size(); ++i) {
+            table[i] = table[i-1] + table[i-2];
+        }
+        return table;
+    }
+
+    constexpr auto table = makeTable();
+
+    // Fast doubling on any unsigned number type: returns {F(n), F(n+1)}
+    template<typename Number>
+    std::pair<Number, Number> fastDoubling(unsigned int n) {
+        if (n == 0) return {Number{0}, Number{1}};
+        const auto [a, b] = fastDoubling<Number>(n / 2);
+        const Number c = a * (b + b - a);  // F(2k)
+        const Number d = a * a + b * b;    // F(2k+1)
+        if (n % 2 == 0) return {c, d};
+        return {d, c + d};
+    }
+}
+
+// Compile-time lookup. Throws for n > maxFibonacci64.
+constexpr std::uint64_t fibonacciTable(unsigned int n) {
+    if (n > maxFibonacci64) {
+        throw std::out_of_range("F(n) doesn't fit in 64 bits");
+    }
+    return fibonacci_detail::table[n];
+}
+
+// Exact F(n) in 64 bits, or an empty optional if it overflows
+inline std::optional<std::uint64_t> fibonacciFastDoubling(unsigned int n) {
+    if (n > maxFibonacci64) return {};
+    if (n < 2) return n;
+    // F(k) and F(k+1) for k = n/2 fit, and so do all intermediate results of the last step
+    const auto [a, b] = fibonacci_detail::fastDoubling<std::uint64_t>(n / 2);
+    if (n % 2 == 0) {
+        // F(2k) = F(k) * (2 F(k+1) - F(k)), and 2 F(k+1) - F(k) = F(k+1) + F(k-1) > 0
+        return a * (b + b - a);
+    }
+    return a * a + b * b;
+}
+
+// A minimal arbitrary-precision unsigned integer, with just enough operations for fast doubling
+class BigUnsigned {
+public:
+    BigUnsigned(std::uint64_t value = 0) {
+        while (value != 0) {
+            m_limbs.push_back(static_cast<std::uint32_t>(value));
+            value >>= 32;
+        }
+    }
+
+    friend BigUnsigned operator+(const BigUnsigned& a, const BigUnsigned& b) {
+        BigUnsigned result;
+        const std::size_t n = std::max(a.m_limbs.size(), b.m_limbs.size());
+        result.m_limbs.resize(n + 1);
+        std::uint64_t carry = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            carry += std::uint64_t{a.limb(i)} + b.limb(i);
+            result.m_limbs[i] = static_cast<std::uint32_t>(carry);
+            carry >>= 32;
+        }
+        result.m_limbs[n] = static_cast<std::uint32_t>(carry);
+        result.trim();
+        return result;
+    }
+
+    // Throws std::underflow_error unless a >= b
+    friend BigUnsigned operator-(const BigUnsigned& a, const BigUnsigned& b) {
+        // Limbs are trimmed, so more limbs means a larger number. The loop below only
+        // looks at a's limbs, and would miss those of b.
+        if (b.m_limbs.size() > a.m_limbs.size()) {
+            throw std::underflow_error("BigUnsigned subtraction would be negative");
+        }
+        BigUnsigned result;
+        result.m_limbs.resize(a.m_limbs.size());
+        std::int64_t borrow = 0;
+        for (std::size_t i = 0; i < a.m_limbs.size(); ++i) {
+            std::int64_t diff = std::int64_t{a.limb(i)} - b.limb(i) - borrow;
+            borrow = diff < 0;
+            if (diff < 0) diff += std::int64_t{1} << 32;
+            result.m_limbs[i] = static_cast<std::uint32_t>(diff);
+        }
+        if (borrow) {
+            throw std::underflow_error("BigUnsigned subtraction would be negative");
+        }
+        result.trim();
+        return result;
+    }
+
+    friend BigUnsigned operator*(const BigUnsigned& a, const BigUnsigned& b) {
+        BigUnsigned result;
+        if (a.m_limbs.empty() || b.m_limbs.empty()) return result;
+        result.m_limbs.assign(a.m_limbs.size() + b.m_limbs.size(), 0);
+        for (std::size_t i = 0; i < a.m_limbs.size(); ++i) {
+            std::uint64_t carry = 0;
+            for (std::size_t j = 0; j < b.m_limbs.size(); ++j) {
+                carry += std::uint64_t{a.m_limbs[i]} * b.m_limbs[j] + result.m_limbs[i+j];
+                result.m_limbs[i+j] = static_cast<std::uint32_t>(carry);
+                carry >>= 32;
+            }
+            result.m_limbs[i + b.m_limbs.size()] = static_cast<std::uint32_t>(carry);
+        }
+        result.trim();
+        return result;
+    }
+
+    friend bool operator==(const BigUnsigned& a, const BigUnsigned& b) {
+        return a.m_limbs == b.m_limbs;
+    }
+
+    friend bool operator!=(const BigUnsigned& a, const BigUnsigned& b) {
+        return !(a == b);
+    }
+
+    std::string toString() const {
+        if (m_limbs.empty()) return "0";
+        // Repeatedly divide by 10^9, and collect the remainders
+        std::vector<std::uint32_t> limbs = m_limbs;
+        std::string digits;
+        while (!limbs.empty()) {
+            std::uint64_t remainder = 0;
+            for (std::size_t i = limbs.size(); i-- > 0;) {
+                const std::uint64_t current = (remainder << 32) | limbs[i];
+                limbs[i] = static_cast<std::uint32_t>(current / 1000000000);
+                remainder = current % 1000000000;
+            }
+            while (!limbs.empty() && limbs.back() == 0) limbs.pop_back();
+            for (int i = 0; i < 9 && (remainder != 0 || !limbs.empty()); ++i) {
+                digits.push_back(static_cast<char>('0' + remainder % 10));
+                remainder /= 10;
+            }
+        }
+        return {digits.rbegin(), digits.rend()};
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const BigUnsigned& number) {
+        return os << number.toString();
+    }
+
+private:
+    std::uint32_t limb(std::size_t i) const { return i < m_limbs.size() ? m_limbs[i] : 0; }
+
+    void trim() {
+        while (!m_limbs.empty() && m_limbs.back() == 0) m_limbs.pop_back();
+    }
+
+    std::vector<std::uint32_t> m_limbs; // least significant first
+};
+
+inline BigUnsigned fibonacciBig(unsigned int n) {
+    return fibonacci_detail::fastDoubling<BigUnsigned>(n).first;
+}
+
+enum class FibonacciAlgorithm {
+    Automatic,    // table for small n, big integers otherwise
+    Table,
+    FastDoubling,
+    BigInteger
+};
+
+// Single entry point. Throws if the chosen 64-bit algorithm can't represent F(n).
+inline BigUnsigned fibonacci(unsigned int n, FibonacciAlgorithm algorithm = FibonacciAlgorithm::Automatic) {
+    switch (algorithm) {
+    case FibonacciAlgorithm::Automatic:
+        return n <= maxFibonacci64 ? BigUnsigned{fibonacciTable(n)} : fibonacciBig(n);
+    case FibonacciAlgorithm::Table:
+        return fibonacciTable(n);
+    case FibonacciAlgorithm::FastDoubling:
+        if (auto result = fibonacciFastDoubling(n)) return *result;
+        throw std::overflow_error("F(n) doesn't fit in 64 bits");
+    case FibonacciAlgorithm::BigInteger:
+        return fibonacciBig(n);
+    }
+    throw std::invalid_argument("Unknown FibonacciAlgorithm");
+}
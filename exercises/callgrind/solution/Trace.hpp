@@ -0,0 +1,215 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * Lightweight tracing: measure how long functions or blocks take, in the running program,
+ * and look at the timeline of all threads in a trace viewer.
+ *
+ * Mark a block with TRACE_SCOPE("name"). When the block ends, its start time and duration
+ * are stored in a ring buffer of the current thread. That costs two reads of the clock and
+ * no lock, usually a few tens of nanoseconds. writeChromeTrace() exports all events in
+ * the Chrome trace event format, which can be opened in https://ui.perfetto.dev or
+ * chrome://tracing.
+ *
+ *   unsigned int fibo(int a) {
+ *     TRACE_SCOPE("fibo");
+ *     ...
+ *   }
+ *   ...
+ *   saveChromeTrace("trace.json");
+ *
+ * Names must be string literals (or live until the export). Every thread keeps its
+ * latest Trace::eventsPerThread events, and older ones are overwritten. Export when the
+ * traced threads are idle, e.g. after joining them.
+ *
+ * Compile with -DTRACING=0 to remove all TRACE_SCOPEs from the program.
+ */
+
+#ifndef TRACING
+#define TRACING 1
+#endif
+
+namespace Trace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t eventsPerThread = 1 << 16;   // a power of 2
+
+struct Event {
+    const char* name;
+    std::int64_t start;      // ns since the start of the program
+    std::int64_t duration;   // ns
+};
+
+// Single writer (the owning thread), ring buffer of its latest events
+struct ThreadBuffer {
+    Event events[eventsPerThread];
+    std::atomic<std::uint64_t> count{0};   // number of events ever written
+    unsigned int threadId;
+    std::string threadName;
+};
+
+class Registry {
+public:
+    static Registry& instance() {
+        static Registry registry;
+        return registry;
+    }
+
+    Clock::time_point origin() const { return m_origin; }
+
+    // The buffer of the calling thread. The first call of a thread allocates it.
+    ThreadBuffer& threadBuffer() {
+        thread_local ThreadBuffer* buffer = registerThread();
+        return *buffer;
+    }
+
+    void writeChromeTrace(std::ostream& os);
+
+    // Number of events that were overwritten because a thread's buffer was full
+    std::uint64_t droppedEvents() {
+        std::scoped_lock lock{m_mutex};
+        std::uint64_t dropped = 0;
+        for (const auto& buffer : m_buffers) {
+            const std::uint64_t count = buffer->count.load(std::memory_order_acquire);
+            if (count > eventsPerThread) dropped += count - eventsPerThread;
+        }
+        return dropped;
+    }
+
+private:
+    ThreadBuffer* registerThread() {
+        auto buffer = std::make_unique<ThreadBuffer>();
+        std::scoped_lock lock{m_mutex};
+        buffer->threadId = static_cast<unsigned int>(m_buffers.size());
+        m_buffers.push_back(std::move(buffer));
+        return m_buffers.back().get();
+    }
+
+    Clock::time_point m_origin = Clock::now();
+    std::mutex m_mutex;
+    // Buffers are kept after their thread exits, so its events can still be exported
+    std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+};
+
+inline std::int64_t now() {
+    // Create the registry, and so the origin, before reading the clock
+    const Clock::time_point origin = Registry::instance().origin();
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - origin).count();
+    return ns > 0 ? ns : 0;
+}
+
+inline void record(const char* name, std::int64_t start, std::int64_t duration) {
+    ThreadBuffer& buffer = Registry::instance().threadBuffer();
+    const std::uint64_t count = buffer.count.load(std::memory_order_relaxed);
+    buffer.events[count & (eventsPerThread - 1)] = Event{name, start, duration};
+    buffer.count.store(count + 1, std::memory_order_release);
+}
+
+// Shown as the name of the calling thread in the viewer
+inline void setThreadName(std::string name) {
+    Registry::instance().threadBuffer().threadName = std::move(name);
+}
+
+// Records the time from its construction to its destruction
+class ScopedTimer {
+public:
+    explicit ScopedTimer(const char* name) : m_name(name), m_start(now()) { }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+    ~ScopedTimer() {
+        record(m_name, m_start, now() - m_start);
+    }
+
+private:
+    const char* m_name;
+    std::int64_t m_start;
+};
+
+namespace detail {
+    inline void writeString(std::ostream& os, std::string_view text) {
+        os << '"';
+        for (char c : text) {
+            if (c == '"' || c == '\\') os << '\\';
+            if (static_cast<unsigned char>(c) >= 0x20) os << c;
+        }
+        os << '"';
+    }
+
+    // Chrome traces count in microseconds
+    inline void writeMicroseconds(std::ostream& os, std::int64_t ns) {
+        if (ns < 0) ns = 0;
+        os << ns / 1000 << '.' << static_cast<char>('0' + ns / 100 % 10)
+           << static_cast<char>('0' + ns / 10 % 10) << static_cast<char>('0' + ns % 10);
+    }
+}
+
+inline void Registry::writeChromeTrace(std::ostream& os) {
+    std::scoped_lock lock{m_mutex};
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&](){
+        if (!first) os << ",\n";
+        first = false;
+    };
+    for (const auto& buffer : m_buffers) {
+        if (!buffer->threadName.empty()) {
+            separator();
+            os << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << buffer->threadId << R"(,"args":{"name":)";
+            detail::writeString(os, buffer->threadName);
+            os << "}}";
+        }
+        const std::uint64_t count = buffer->count.load(std::memory_order_acquire);
+        const std::uint64_t begin = count > eventsPerThread ? count - eventsPerThread : 0;
+        for (std::uint64_t i = begin; i < count; ++i) {
+            const Event& event = buffer->events[i & (eventsPerThread - 1)];
+            separator();
+            os << R"({"name":)";
+            detail::writeString(os, event.name);
+            os << R"(,"ph":"X","pid":1,"tid":)" << buffer->threadId << R"(,"ts":)";
+            detail::writeMicroseconds(os, event.start);
+            os << R"(,"dur":)";
+            detail::writeMicroseconds(os, event.duration);
+            os << '}';
+        }
+    }
+    os << "\n]}\n";
+}
+
+inline void writeChromeTrace(std::ostream& os) {
+    Registry::instance().writeChromeTrace(os);
+}
+
+inline void saveChromeTrace(const std::string& fileName) {
+    std::ofstream file(fileName);
+    writeChromeTrace(file);
+    if (!file) {
+        throw std::runtime_error("Could not write " + fileName);
+    }
+}
+
+inline std::uint64_t droppedEvents() {
+    return Registry::instance().droppedEvents();
+}
+
+} // namespace Trace
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+
+#if TRACING
+#define TRACE_SCOPE(name) ::Trace::ScopedTimer TRACE_CONCAT(traceScope, __LINE__){name}
+#else
+#define TRACE_SCOPE(name) do { } while (false)
+#endif
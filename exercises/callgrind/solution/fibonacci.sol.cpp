@@ -0,0 +1,81 @@
+#include "Fibonacci.hpp"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+/*
+ * Validate the Fibonacci engines against each other, and against the functions from
+ * fibocrunch.cpp. Note that fibo(n) == F(n+1).
+ */
+
+unsigned int fibo(int a) {
+    if (a == 1 || a == 0) {
+        return 1;
+    } else {
+        return fibo(a-1)+fibo(a-2);
+    }
+}
+
+unsigned int fibo2(int n) {
+    return static_cast<unsigned int>((1/std::sqrt(5)) * (std::pow(((1 + std::sqrt(5)) / 2), n) - std::pow(((1 - std::sqrt(5)) / 2), n)));
+}
+
+// The table is computed by the compiler
+static_assert(fibonacciTable(10) == 55);
+static_assert(fibonacciTable(maxFibonacci64) == 12200160415121876738ull);
+
+int main() {
+    unsigned int nErrors = 0;
+    auto check = [&nErrors](bool ok, const char* what, unsigned int n) {
+        if (!ok) {
+            std::cerr << what << " is wrong for n = " << n << '\n';
+            nErrors++;
+        }
+    };
+
+    // All 64-bit engines agree with the big integers, and with an iterative sum
+    BigUnsigned previous = 1;
+    BigUnsigned current = 0;
+    for (unsigned int n = 0; n <= 1000; ++n) {
+        check(fibonacciBig(n) == current, "fibonacciBig", n);
+        if (n <= maxFibonacci64) {
+            check(fibonacciTable(n) == fibonacciFastDoubling(n), "fibonacciFastDoubling", n);
+            check(BigUnsigned{fibonacciTable(n)} == current, "fibonacciTable", n);
+        } else {
+            check(!fibonacciFastDoubling(n), "Overflow detection", n);
+        }
+        if (n >= 1 && n <= 30) {
+            check(fibo(n-1) == fibonacciTable(n), "fibo", n);
+        }
+        const BigUnsigned next = previous + current;
+        previous = current;
+        current = next;
+    }
+
+    // fibo2 returns an unsigned int, so it can't go beyond F(47).
+    // Where does its floating-point formula stop being exact with 64-bit results?
+    for (unsigned int n = 0; n <= maxFibonacci64; ++n) {
+        if (n <= 47) check(fibo2(n) == fibonacciTable(n), "fibo2", n);
+        const auto binet = static_cast<std::uint64_t>(std::llround(std::pow((1 + std::sqrt(5)) / 2, n) / std::sqrt(5)));
+        if (binet != fibonacciTable(n)) {
+            std::cout << "The floating-point formula is first wrong for n = " << n << ": " << binet
+                      << " instead of " << fibonacciTable(n) << '\n';
+            break;
+        }
+    }
+
+    for (auto algorithm : {FibonacciAlgorithm::Table, FibonacciAlgorithm::FastDoubling,
+                           FibonacciAlgorithm::BigInteger}) {
+        std::cout << "F(90) = " << fibonacci(90, algorithm) << '\n';
+    }
+    std::cout << "F(500) = " << fibonacci(500) << '\n';
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto large = fibonacciBig(100000);
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "F(100000) has " << large.toString().size() << " digits, computed in "
+              << elapsed.count() << " ms\n";
+
+    std::cout << (nErrors == 0 ? "All engines agree\n" : "Errors found!\n");
+    return nErrors;
+}
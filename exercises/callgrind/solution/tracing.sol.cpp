@@ -0,0 +1,116 @@
+#include "Trace.hpp"
+
+#include <chrono>
+#include <complex>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * fibocrunch, instrumented with TRACE_SCOPE instead of run under valgrind, plus the
+ * mandelbrot kernel of the python exercise computed on a few threads.
+ * Writes trace.json (or the file given as first argument): open it in https://ui.perfetto.dev
+ * or chrome://tracing to see the timeline of every thread.
+ */
+
+constexpr auto NBITERATIONS = 20;
+constexpr auto MAX = 16u;
+
+unsigned int power(unsigned int a, unsigned int b) {
+    TRACE_SCOPE("power");
+    unsigned int res = 1;
+    for (unsigned int i = 0; i < b; i++) res *= a;
+    return res;
+}
+
+unsigned int fibo(int a) {
+    TRACE_SCOPE("fibo");
+    if (a == 1 || a == 0) {
+        return 1;
+    } else {
+        return fibo(a-1)+fibo(a-2);
+    }
+}
+
+// Same as mandel() in ../python/mandel.cpp
+int mandel(const std::complex<double>& a) {
+    TRACE_SCOPE("mandel");
+    std::complex<double> z{0, 0};
+    for (int n = 1; n < 100; n++) {
+        z = z*z + a;
+        if (std::norm(z) > 4) {
+            return n;
+        }
+    }
+    return -1;
+}
+
+void mandelRows(int firstRow, int lastRow, int width, int height, std::vector<int>& image) {
+    for (int row = firstRow; row < lastRow; ++row) {
+        TRACE_SCOPE("mandel row");
+        for (int column = 0; column < width; ++column) {
+            const std::complex<double> c{-2. + 3. * column / width, -1. + 2. * row / height};
+            image[row * width + column] = mandel(c);
+        }
+    }
+}
+
+// Cost of an empty zone, which is the overhead added to every traced function
+void measureOverhead() {
+    constexpr int nZones = 1'000'000;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < nZones; ++i) {
+        TRACE_SCOPE("empty");
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Overhead per zone: " << elapsed.count() / nZones << " ns\n";
+}
+
+int main(int argc, char* argv[]) {
+    const std::string fileName = argc > 1 ? argv[1] : "trace.json";
+    Trace::setThreadName("main");
+
+    {
+        TRACE_SCOPE("fibocrunch");
+        std::default_random_engine e;
+        std::uniform_int_distribution d{0u, MAX};
+        unsigned int sum = 0;
+        for (unsigned int i = 0; i < NBITERATIONS; i++) {
+            TRACE_SCOPE("iteration");
+            unsigned int a = d(e);
+            unsigned int b = d(e);
+            sum += power(a, b);
+            sum += fibo(a);
+        }
+        std::cout << "fibocrunch checksum: " << sum << '\n';
+    }
+
+    {
+        TRACE_SCOPE("mandelbrot");
+        constexpr int width = 160, height = 80, nThreads = 4;
+        std::vector<int> image(width * height);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < nThreads; ++t) {
+            threads.emplace_back([&, t](){
+                Trace::setThreadName("mandel " + std::to_string(t));
+                mandelRows(height * t / nThreads, height * (t + 1) / nThreads, width, height, image);
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        int inside = 0;
+        for (int n : image) inside += n < 0;
+        std::cout << "mandelbrot: " << inside << " of " << image.size() << " points inside\n";
+    }
+
+    Trace::saveChromeTrace(fileName);
+    std::cout << "Trace written to " << fileName;
+    if (const auto dropped = Trace::droppedEvents()) {
+        std::cout << " (" << dropped << " older events were overwritten)";
+    }
+    std::cout << '\n';
+
+    // After the export, so its events don't push the interesting ones out of the buffer
+    measureOverhead();
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+/*
+ * Measure memory usage from inside a program: this header replaces the global operator new
+ * and delete, and counts the allocations, and the bytes that are currently allocated.
+ *
+ *   const std::size_t before = allocatedBytes();
+ *   std::map<int, int> map = ...;
+ *   std::cout << allocatedBytes() - before << " bytes for the map\n";
+ *
+ * The operators are not inline, so include this header in only one source file of a
+ * program. Only allocations through operator new are seen, not those with malloc. Aligned
+ * operator new is not replaced.
+ */
+
+namespace allocation_counter_detail {
+    inline std::atomic<std::size_t> allocationCount{0};
+    inline std::atomic<std::size_t> liveBytes{0};
+
+    // The size is stored in front of the block, so delete knows it
+    constexpr std::size_t headerSize = alignof(std::max_align_t);
+}
+
+// Number of calls to operator new so far
+inline std::size_t allocations() {
+    return allocation_counter_detail::allocationCount.load(std::memory_order_relaxed);
+}
+
+// Bytes allocated with operator new, and not deleted yet
+inline std::size_t allocatedBytes() {
+    return allocation_counter_detail::liveBytes.load(std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t size) {
+    using namespace allocation_counter_detail;
+    if (size > static_cast<std::size_t>(-1) - headerSize) throw std::bad_alloc{};
+    auto block = static_cast<char*>(std::malloc(size + headerSize));
+    if (!block) throw std::bad_alloc{};
+    *reinterpret_cast<std::size_t*>(block) = size;
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    liveBytes.fetch_add(size, std::memory_order_relaxed);
+    return block + headerSize;
+}
+
+void operator delete(void* ptr) noexcept {
+    using namespace allocation_counter_detail;
+    if (!ptr) return;
+    // Through an integer, so the compiler doesn't take ptr for the start of an object
+    auto block = reinterpret_cast<std::size_t*>(reinterpret_cast<std::uintptr_t>(ptr) - headerSize);
+    liveBytes.fetch_sub(*block, std::memory_order_relaxed);
+    std::free(block);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
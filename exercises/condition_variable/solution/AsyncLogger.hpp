@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * An asynchronous logger, as a replacement for SafeCout.
+ *
+ * SafeCout formats into a std::stringstream (which allocates), and then all threads queue
+ * up on one mutex to write to std::cout. Here instead:
+ * - AsyncCout formats into a fixed-size line on the stack, without any allocation.
+ * - Every thread owns a ring buffer of lines. Handing a line over is a copy and one atomic
+ *   store. Only the logging thread writes to the ring, and only the writer reads from it,
+ *   so no lock is needed.
+ * - A background thread collects the lines of all threads, and writes them to the sink in
+ *   large batches.
+ *
+ * Each line is written in one piece, but lines of different threads can be reordered.
+ * Lines longer than AsyncLogger::maxLineLength are truncated, and still end with '\n'.
+ * The first line a thread logs allocates its ring buffer.
+ *
+ * Usage:
+ *   AsyncCout{} << '[' << threadIdx << "] Data processing completed\n";
+ */
+class AsyncLogger {
+public:
+    static constexpr std::size_t maxLineLength = 254;
+    static constexpr std::size_t linesPerThread = 256;
+
+    struct Line {
+        std::uint16_t length = 0;
+        char text[maxLineLength];
+    };
+
+    explicit AsyncLogger(std::ostream& sink = std::cout)
+      : m_id(nextId++), m_sink(sink), m_writer([this](){ writerLoop(); }) { }
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    // Writes out everything that was logged before
+    ~AsyncLogger() {
+        m_stop.store(true, std::memory_order_release);
+        m_writer.join();
+    }
+
+    // The logger used by AsyncCout
+    static AsyncLogger& instance() {
+        static AsyncLogger logger;
+        return logger;
+    }
+
+    // Hand a line to the writer thread. Blocks only if this thread's ring buffer is full.
+    void write(const Line& line) {
+        ThreadBuffer& buffer = threadBuffer();
+        const std::size_t head = buffer.head.load(std::memory_order_relaxed);
+        while (head - buffer.tail.load(std::memory_order_acquire) == linesPerThread) {
+            std::this_thread::yield();
+        }
+        Line& slot = buffer.lines[head % linesPerThread];
+        slot.length = line.length;
+        std::memcpy(slot.text, line.text, line.length);
+        buffer.head.store(head + 1, std::memory_order_release);
+    }
+
+private:
+    // Single producer (the owning thread), single consumer (the writer) ring buffer
+    struct ThreadBuffer {
+        Line lines[linesPerThread];
+        alignas(64) std::atomic<std::size_t> head{0};
+        alignas(64) std::atomic<std::size_t> tail{0};
+        std::atomic<bool> threadExited{false};
+    };
+
+    // The ring buffers of the calling thread, one per logger
+    struct ThreadBuffers {
+        std::vector<std::pair<unsigned int, std::shared_ptr<ThreadBuffer>>> buffers;
+        ~ThreadBuffers() {
+            for (auto& entry : buffers) entry.second->threadExited.store(true, std::memory_order_release);
+        }
+    };
+
+    ThreadBuffer& threadBuffer() {
+        thread_local ThreadBuffers threadBuffers;
+        for (auto& [id, buffer] : threadBuffers.buffers) {
+            if (id == m_id) return *buffer;
+        }
+        // First line of this thread: register a new buffer
+        auto buffer = std::make_shared<ThreadBuffer>();
+        {
+            std::scoped_lock lock{m_mutex};
+            m_buffers.push_back(buffer);
+        }
+        threadBuffers.buffers.emplace_back(m_id, buffer);
+        return *buffer;
+    }
+
+    // Append all available lines to batch. Returns false if there was nothing.
+    bool drain(std::string& batch) {
+        bool foundLines = false;
+        std::scoped_lock lock{m_mutex};
+        for (auto& buffer : m_buffers) {
+            const std::size_t head = buffer->head.load(std::memory_order_acquire);
+            std::size_t tail = buffer->tail.load(std::memory_order_relaxed);
+            for (; tail != head; ++tail) {
+                const Line& line = buffer->lines[tail % linesPerThread];
+                batch.append(line.text, line.length);
+                foundLines = true;
+            }
+            buffer->tail.store(tail, std::memory_order_release);
+        }
+        // Forget the buffers of threads that are gone, once they are empty
+        m_buffers.erase(std::remove_if(m_buffers.begin(), m_buffers.end(), [](const auto& buffer){
+            return buffer->threadExited.load(std::memory_order_acquire) &&
+                   buffer->head.load(std::memory_order_acquire) == buffer->tail.load(std::memory_order_relaxed);
+        }), m_buffers.end());
+        return foundLines;
+    }
+
+    void writerLoop() {
+        std::string batch;
+        batch.reserve(linesPerThread * sizeof(Line));
+        while (true) {
+            const bool stopping = m_stop.load(std::memory_order_acquire);
+            if (drain(batch)) {
+                m_sink.write(batch.data(), batch.size());
+                m_sink.flush();
+                batch.clear();
+            } else if (stopping) {
+                return;
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds{1});
+            }
+        }
+    }
+
+    inline static std::atomic<unsigned int> nextId{0};
+
+    const unsigned int m_id;
+    std::ostream& m_sink;
+    std::mutex m_mutex; // protects m_buffers, only taken when a thread logs its first line
+    std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+    std::atomic<bool> m_stop{false};
+    std::thread m_writer;
+};
+
+// Drop-in replacement for SafeCout. Formats into a line on the stack, and hands it to
+// the logger when destructed.
+class AsyncCout {
+public:
+    explicit AsyncCout(AsyncLogger& logger = AsyncLogger::instance()) : m_logger(logger) { }
+
+    AsyncCout(const AsyncCout&) = delete;
+    AsyncCout& operator=(const AsyncCout&) = delete;
+
+    ~AsyncCout() {
+        if (m_truncated) {
+            // There is always room for it, see capacity
+            m_line.text[m_line.length++] = '\n';
+        }
+        m_logger.write(m_line);
+    }
+
+    AsyncCout& operator<<(std::string_view text) {
+        if (m_truncated) return *this;
+        const std::size_t n = std::min(text.size(), capacity - m_line.length);
+        m_truncated |= n < text.size();
+        std::memcpy(m_line.text + m_line.length, text.data(), n);
+        m_line.length += static_cast<std::uint16_t>(n);
+        return *this;
+    }
+
+    AsyncCout& operator<<(const char* text) {
+        return *this << std::string_view{text};
+    }
+
+    AsyncCout& operator<<(const std::string& text) {
+        return *this << std::string_view{text};
+    }
+
+    AsyncCout& operator<<(char c) {
+        return *this << std::string_view{&c, 1};
+    }
+
+    // Numbers are formatted like std::ostream does by default
+    template<typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+    AsyncCout& operator<<(T value) {
+        if (m_truncated) return *this;
+        char* first = m_line.text + m_line.length;
+        char* last = m_line.text + capacity;
+        std::to_chars_result result;
+        if constexpr (std::is_floating_point_v<T>) {
+            result = std::to_chars(first, last, value, std::chars_format::general, 6);
+        } else {
+            result = std::to_chars(first, last, static_cast<std::conditional_t<std::is_same_v<T, bool>, int, T>>(value));
+        }
+        if (result.ec == std::errc{}) {
+            m_line.length = static_cast<std::uint16_t>(result.ptr - m_line.text);
+        } else {
+            m_truncated = true;
+        }
+        return *this;
+    }
+
+private:
+    // The last byte is kept free for the '\n' of a truncated line
+    static constexpr std::size_t capacity = AsyncLogger::maxLineLength - 1;
+
+    AsyncLogger& m_logger;
+    AsyncLogger::Line m_line;
+    bool m_truncated = false;
+};
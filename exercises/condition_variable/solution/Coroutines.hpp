@@ -0,0 +1,389 @@
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+ * A small C++20 coroutine runtime for producer/consumer code.
+ *
+ * In condition_variable.cpp, every consumer is an OS thread that blocks in cond.wait().
+ * Here, consumers are coroutines: a waiting consumer is only a suspended coroutine frame
+ * (on the order of a hundred bytes on the heap), and one thread runs thousands of them.
+ *
+ * - Task<T>:   a coroutine that returns a T. It starts when it is awaited, or when it is
+ *              given to Executor::spawn().
+ * - Executor:  runs ready coroutines one after the other on the thread that calls run(),
+ *              and wakes up sleeping ones. run() returns when nothing is left to do.
+ * - Event:     co_await event suspends until somebody calls event.set().
+ * - Channel<T>: a bounded queue. co_await channel.send(value) suspends while the channel is
+ *              full, co_await channel.receive() while it is empty. After close(), receive()
+ *              returns an empty optional once the channel is drained, and send() throws
+ *              std::logic_error, also in senders that were waiting for space.
+ *
+ * Usage:
+ *   Executor executor;
+ *   Event ready{executor};
+ *   executor.spawn([&]() -> Task<> { co_await ready; ... }());
+ *   executor.spawn([&]() -> Task<> { co_await executor.sleepFor(1s); ready.set(); }());
+ *   executor.run();
+ *
+ * Everything runs on one thread, so none of these classes are thread safe. Spawn one
+ * Executor per thread to use more cores. Let run() finish before destroying the Executor.
+ */
+
+class Executor;
+
+namespace coroutine_detail {
+    // Promise parts that don't depend on the return type
+    struct PromiseBase {
+        std::coroutine_handle<> continuation;   // the coroutine awaiting this one
+        std::exception_ptr exception;
+        bool detached = false;                   // started by Executor::spawn()
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        // When done, continue with the awaiting coroutine, or clean up a detached one
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            template<typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+                PromiseBase& promise = handle.promise();
+                if (promise.continuation) return promise.continuation;
+                if (promise.detached) {
+                    if (promise.exception) std::terminate();
+                    handle.destroy();
+                }
+                return std::noop_coroutine();
+            }
+            void await_resume() noexcept { }
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void unhandled_exception() { exception = std::current_exception(); }
+    };
+
+    template<typename T>
+    struct Promise : PromiseBase {
+        std::optional<T> value;
+        template<typename U>
+        void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+        T result() {
+            if (exception) std::rethrow_exception(exception);
+            return std::move(*value);
+        }
+    };
+
+    template<>
+    struct Promise<void> : PromiseBase {
+        void return_void() { }
+        void result() {
+            if (exception) std::rethrow_exception(exception);
+        }
+    };
+
+    // An intrusive FIFO list of awaiters. The awaiters live in the suspended coroutine
+    // frames, so waiting doesn't allocate.
+    template<typename Awaiter>
+    class WaiterList {
+    public:
+        bool empty() const { return m_head == nullptr; }
+
+        void push(Awaiter* waiter) {
+            waiter->next = nullptr;
+            if (m_tail) m_tail->next = waiter; else m_head = waiter;
+            m_tail = waiter;
+        }
+
+        Awaiter* pop() {
+            Awaiter* waiter = m_head;
+            m_head = waiter->next;
+            if (!m_head) m_tail = nullptr;
+            return waiter;
+        }
+
+    private:
+        Awaiter* m_head = nullptr;
+        Awaiter* m_tail = nullptr;
+    };
+}
+
+template<typename T = void>
+class [[nodiscard]] Task {
+public:
+    struct promise_type : coroutine_detail::Promise<T> {
+        Task get_return_object() {
+            return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+    };
+
+    Task(Task&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) { }
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (m_handle) m_handle.destroy();
+            m_handle = std::exchange(other.m_handle, {});
+        }
+        return *this;
+    }
+    ~Task() {
+        if (m_handle) m_handle.destroy();
+    }
+
+    // Start the task, and resume the awaiting coroutine when it's done
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+            T await_resume() { return handle.promise().result(); }
+        };
+        return Awaiter{m_handle};
+    }
+
+private:
+    friend class Executor;
+    explicit Task(std::coroutine_handle<promise_type> handle) : m_handle(handle) { }
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+class Executor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    Executor() = default;
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    // Run a task in the background. It is destroyed when it's done.
+    // If it throws, the program terminates (like with std::thread).
+    template<typename T>
+    void spawn(Task<T> task) {
+        auto handle = std::exchange(task.m_handle, {});
+        handle.promise().detached = true;
+        post(handle);
+    }
+
+    // Resume the coroutine soon
+    void post(std::coroutine_handle<> handle) {
+        m_ready.push_back(handle);
+    }
+
+    // co_await executor.yield() lets the other ready coroutines run first
+    auto yield() {
+        struct Awaiter {
+            Executor& executor;
+            bool await_ready() noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { executor.post(handle); }
+            void await_resume() noexcept { }
+        };
+        return Awaiter{*this};
+    }
+
+    auto sleepUntil(Clock::time_point deadline) {
+        struct Awaiter {
+            Executor& executor;
+            Clock::time_point deadline;
+            bool await_ready() noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) {
+                executor.m_timers.push({deadline, executor.m_nextTimer++, handle});
+            }
+            void await_resume() noexcept { }
+        };
+        return Awaiter{*this, deadline};
+    }
+
+    template<typename Rep, typename Period>
+    auto sleepFor(std::chrono::duration<Rep, Period> duration) {
+        return sleepUntil(Clock::now() + std::chrono::duration_cast<Clock::duration>(duration));
+    }
+
+    // Run until no coroutine is ready or sleeping. Coroutines that wait for an event or a
+    // channel that nobody will signal any more stay suspended.
+    void run() {
+        while (true) {
+            // Wake up the coroutines whose time has come
+            const auto now = Clock::now();
+            while (!m_timers.empty() && m_timers.top().deadline <= now) {
+                m_ready.push_back(m_timers.top().handle);
+                m_timers.pop();
+            }
+            if (!m_ready.empty()) {
+                auto handle = m_ready.front();
+                m_ready.pop_front();
+                handle.resume();
+            } else if (!m_timers.empty()) {
+                std::this_thread::sleep_until(m_timers.top().deadline);
+            } else {
+                return;
+            }
+        }
+    }
+
+private:
+    struct Timer {
+        Clock::time_point deadline;
+        unsigned long sequence;   // keeps timers with the same deadline in order
+        std::coroutine_handle<> handle;
+        bool operator>(const Timer& other) const {
+            return std::pair(deadline, sequence) > std::pair(other.deadline, other.sequence);
+        }
+    };
+
+    std::deque<std::coroutine_handle<>> m_ready;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<>> m_timers;
+    unsigned long m_nextTimer = 0;
+};
+
+// A one-shot event, like a condition variable together with its "ready" flag
+class Event {
+public:
+    explicit Event(Executor& executor) : m_executor(executor) { }
+    Event(const Event&) = delete;
+    Event& operator=(const Event&) = delete;
+
+    struct Awaiter {
+        Event& event;
+        Awaiter* next = nullptr;
+        std::coroutine_handle<> handle{};
+
+        bool await_ready() const noexcept { return event.m_set; }
+        void await_suspend(std::coroutine_handle<> awaiting) {
+            handle = awaiting;
+            event.m_waiters.push(this);
+        }
+        void await_resume() noexcept { }
+    };
+
+    Awaiter operator co_await() noexcept { return Awaiter{*this}; }
+
+    bool isSet() const { return m_set; }
+
+    // Wake up all waiting coroutines. Later co_awaits don't suspend any more.
+    void set() {
+        m_set = true;
+        while (!m_waiters.empty()) {
+            m_executor.post(m_waiters.pop()->handle);
+        }
+    }
+
+private:
+    Executor& m_executor;
+    bool m_set = false;
+    coroutine_detail::WaiterList<Awaiter> m_waiters;
+};
+
+template<typename T>
+class Channel {
+public:
+    // With capacity 0, every send waits for a receiver
+    Channel(Executor& executor, std::size_t capacity) : m_executor(executor), m_capacity(capacity) { }
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+
+    struct SendAwaiter {
+        Channel& channel;
+        T value;
+        SendAwaiter* next = nullptr;
+        std::coroutine_handle<> handle{};
+        bool cancelled = false;   // the channel was closed before the value was taken
+
+        bool await_ready() {
+            if (channel.m_closed) {
+                throw std::logic_error("Sending to a closed channel");
+            }
+            if (!channel.m_receivers.empty()) {
+                // Hand the value directly to a waiting receiver
+                auto receiver = channel.m_receivers.pop();
+                receiver->value.emplace(std::move(value));
+                channel.m_executor.post(receiver->handle);
+                return true;
+            }
+            if (channel.m_buffer.size() < channel.m_capacity) {
+                channel.m_buffer.push_back(std::move(value));
+                return true;
+            }
+            return false;
+        }
+        void await_suspend(std::coroutine_handle<> awaiting) {
+            handle = awaiting;
+            channel.m_senders.push(this);
+        }
+        void await_resume() const {
+            if (cancelled) {
+                throw std::logic_error("Channel closed while sending");
+            }
+        }
+    };
+
+    struct ReceiveAwaiter {
+        Channel& channel;
+        std::optional<T> value{};
+        ReceiveAwaiter* next = nullptr;
+        std::coroutine_handle<> handle{};
+
+        bool await_ready() {
+            if (!channel.m_buffer.empty()) {
+                value.emplace(std::move(channel.m_buffer.front()));
+                channel.m_buffer.pop_front();
+                // Now there is space for a waiting sender
+                if (!channel.m_senders.empty()) {
+                    auto sender = channel.m_senders.pop();
+                    channel.m_buffer.push_back(std::move(sender->value));
+                    channel.m_executor.post(sender->handle);
+                }
+                return true;
+            }
+            if (!channel.m_senders.empty()) {
+                // Capacity 0: take the value directly from the sender
+                auto sender = channel.m_senders.pop();
+                value.emplace(std::move(sender->value));
+                channel.m_executor.post(sender->handle);
+                return true;
+            }
+            return channel.m_closed;
+        }
+        void await_suspend(std::coroutine_handle<> awaiting) {
+            handle = awaiting;
+            channel.m_receivers.push(this);
+        }
+        std::optional<T> await_resume() { return std::move(value); }
+    };
+
+    SendAwaiter send(T value) { return SendAwaiter{*this, std::move(value)}; }
+    ReceiveAwaiter receive() { return ReceiveAwaiter{*this}; }
+
+    // No more values will be sent. Waiting receivers get an empty optional, and waiting
+    // senders a std::logic_error: their values are dropped.
+    void close() {
+        m_closed = true;
+        while (!m_receivers.empty()) {
+            m_executor.post(m_receivers.pop()->handle);
+        }
+        while (!m_senders.empty()) {
+            auto sender = m_senders.pop();
+            sender->cancelled = true;
+            m_executor.post(sender->handle);
+        }
+    }
+
+private:
+    Executor& m_executor;
+    std::size_t m_capacity;
+    std::deque<T> m_buffer;
+    bool m_closed = false;
+    coroutine_detail::WaiterList<SendAwaiter> m_senders;
+    coroutine_detail::WaiterList<ReceiveAwaiter> m_receivers;
+};
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+/*
+ * A mutex and a condition variable that first spin for a short time, and only then go to
+ * sleep in the kernel.
+ *
+ * Going to sleep and waking up again costs a few microseconds, which is more than many
+ * critical sections take. If the lock is released (or the condition variable notified)
+ * soon, a short spin avoids the system calls altogether. The spin is bounded: it doubles
+ * the pause between two checks until maxBackoff, yielding the CPU for the long pauses,
+ * and then parks the thread with C++20 atomic wait (a futex on Linux).
+ * On a machine with a single CPU, spinning can't help, so we park right away.
+ *
+ * HybridMutex / HybridConditionVariable replace std::mutex / std::condition_variable:
+ *   HybridMutex mutex;
+ *   HybridConditionVariable cond;
+ *   std::unique_lock lock{mutex};
+ *   cond.wait(lock, [&](){ return data.isReady(); });
+ * There are no timed waits.
+ */
+
+namespace hybrid_detail {
+    // Tell the CPU that we are spinning (saves power, and frees the core for a hyperthread)
+    inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    // Pauses between two checks double from 1 to maxBackoff, so we spin for at most
+    // about 2 * maxBackoff pauses (a few microseconds)
+    constexpr unsigned int maxBackoff = 1024;
+    constexpr unsigned int yieldBackoff = 64;
+
+    // Spin until done() returns true, or until we gave up. Returns done().
+    template<typename Predicate>
+    bool spinUntil(Predicate done) {
+        static const bool spinningHelps = std::thread::hardware_concurrency() > 1;
+        if (!spinningHelps) return done();
+        for (unsigned int backoff = 1; backoff <= maxBackoff; backoff *= 2) {
+            if (done()) return true;
+            if (backoff >= yieldBackoff) {
+                std::this_thread::yield();
+            } else {
+                for (unsigned int i = 0; i < backoff; ++i) cpuRelax();
+            }
+        }
+        return done();
+    }
+}
+
+class HybridMutex {
+public:
+    HybridMutex() = default;
+    HybridMutex(const HybridMutex&) = delete;
+    HybridMutex& operator=(const HybridMutex&) = delete;
+
+    void lock() {
+        // Fast path, and spin while somebody else holds the lock
+        if (hybrid_detail::spinUntil([this](){ return try_lock(); })) return;
+        // Park. We set the state to "contended", so the unlocking thread knows it has to
+        // wake somebody up.
+        while (m_state.exchange(contended, std::memory_order_acquire) != unlocked) {
+            m_state.wait(contended, std::memory_order_relaxed);
+        }
+    }
+
+    bool try_lock() {
+        // Read first, so spinning threads don't steal the cache line from the owner
+        unsigned int expected = unlocked;
+        return m_state.load(std::memory_order_relaxed) == unlocked &&
+               m_state.compare_exchange_strong(expected, locked, std::memory_order_acquire,
+                                               std::memory_order_relaxed);
+    }
+
+    void unlock() {
+        // Only make a system call if somebody might be sleeping
+        if (m_state.exchange(unlocked, std::memory_order_release) == contended) {
+            m_state.notify_one();
+        }
+    }
+
+private:
+    static constexpr unsigned int unlocked = 0;
+    static constexpr unsigned int locked = 1;      // no thread is parked
+    static constexpr unsigned int contended = 2;   // threads might be parked
+
+    std::atomic<unsigned int> m_state{unlocked};
+};
+
+class HybridConditionVariable {
+public:
+    HybridConditionVariable() = default;
+    HybridConditionVariable(const HybridConditionVariable&) = delete;
+    HybridConditionVariable& operator=(const HybridConditionVariable&) = delete;
+
+    // Like std::condition_variable, wait() may return spuriously
+    template<typename Lock>
+    void wait(Lock& lock) {
+        // Read the sequence number while we hold the lock. Any notify after this changes it,
+        // so we can't miss one.
+        const unsigned int sequence = m_sequence.load(std::memory_order_relaxed);
+        lock.unlock();
+        const auto notified = [&](){ return m_sequence.load(std::memory_order_acquire) != sequence; };
+        if (!hybrid_detail::spinUntil(notified)) {
+            // Announce that we sleep. The fence pairs with the one in wake(): either we
+            // see the new sequence, or the notifying thread sees us waiting.
+            m_waiters.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            while (!notified()) {
+                m_sequence.wait(sequence, std::memory_order_acquire);
+            }
+            m_waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+        lock.lock();
+    }
+
+    template<typename Lock, typename Predicate>
+    void wait(Lock& lock, Predicate predicate) {
+        while (!predicate()) {
+            wait(lock);
+        }
+    }
+
+    void notify_one() {
+        if (wake()) m_sequence.notify_one();
+    }
+
+    void notify_all() {
+        if (wake()) m_sequence.notify_all();
+    }
+
+private:
+    // Returns true if threads might be parked
+    bool wake() {
+        m_sequence.fetch_add(1, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return m_waiters.load(std::memory_order_relaxed) != 0;
+    }
+
+    std::atomic<unsigned int> m_sequence{0};
+    std::atomic<unsigned int> m_waiters{0};
+};
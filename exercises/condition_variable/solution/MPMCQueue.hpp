@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <utility>
+
+/*
+ * A bounded lock-free queue for many producers and many consumers (after D. Vyukov).
+ *
+ * The queue is a ring buffer of cells. Each cell has a sequence number that tells whether
+ * it is free for the producer of a given position, or filled for the consumer of that
+ * position. Producers and consumers claim positions with a compare-and-swap on their own
+ * counter, so they never take a lock, and producers don't contend with consumers.
+ *
+ * tryPush() / tryPop() return immediately. push() / pop() block when the queue is full or
+ * empty. Blocked threads sleep with C++20 atomic wait (a futex on Linux), and they are
+ * only woken up if somebody is actually waiting, so the fast path makes no system call.
+ */
+template<typename T>
+class MPMCQueue {
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+public:
+    // The capacity is rounded up to a power of two
+    explicit MPMCQueue(std::size_t capacity) {
+        std::size_t size = 2;
+        while (size < capacity) size *= 2;
+        m_mask = size - 1;
+        m_cells = std::make_unique<Cell[]>(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MPMCQueue(const MPMCQueue&) = delete;
+    MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+    std::size_t capacity() const { return m_mask + 1; }
+
+    // Returns false if the queue is full. value is only moved from on success.
+    bool tryPush(T& value) {
+        std::size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = m_cells[pos & m_mask];
+            const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+            if (diff == 0) {
+                // The cell is free: try to claim this position
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    notify(m_pushCount, m_waitingConsumers);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPush(T&& value) {
+        return tryPush(value);
+    }
+
+    // Returns an empty optional if the queue is empty
+    std::optional<T> tryPop() {
+        std::size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = m_cells[pos & m_mask];
+            const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence - (pos + 1));
+            if (diff == 0) {
+                // The cell is filled: try to claim this position
+                if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    std::optional<T> result{std::move(cell.value)};
+                    // Mark the cell as free for the producer one round later
+                    cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+                    notify(m_popCount, m_waitingProducers);
+                    return result;
+                }
+            } else if (diff < 0) {
+                return {}; // empty
+            } else {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void push(T value) {
+        // Retry a few times before going to sleep, the queue is usually only full briefly
+        for (unsigned int i = 0; i < spinCount; ++i) {
+            if (tryPush(value)) return;
+            std::this_thread::yield();
+        }
+        while (true) {
+            // Announce that we might sleep, and read the counter before trying,
+            // so we can't miss a pop in between
+            m_waitingProducers.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const auto pops = m_popCount.load();
+            if (tryPush(value)) {
+                m_waitingProducers.fetch_sub(1);
+                return;
+            }
+            m_popCount.wait(pops);
+            m_waitingProducers.fetch_sub(1);
+        }
+    }
+
+    T pop() {
+        for (unsigned int i = 0; i < spinCount; ++i) {
+            if (auto result = tryPop()) return std::move(*result);
+            std::this_thread::yield();
+        }
+        while (true) {
+            m_waitingConsumers.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const auto pushes = m_pushCount.load();
+            if (auto result = tryPop()) {
+                m_waitingConsumers.fetch_sub(1);
+                return std::move(*result);
+            }
+            m_pushCount.wait(pushes);
+            m_waitingConsumers.fetch_sub(1);
+        }
+    }
+
+private:
+    static constexpr unsigned int spinCount = 16;
+
+    // Wake up the sleepers, but only if there are any. The fence pairs with the one in
+    // push() / pop(): either we see the waiter, or the waiter sees our change to the queue.
+    static void notify(std::atomic<unsigned int>& counter, std::atomic<unsigned int>& waiting) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed) != 0) {
+            counter.fetch_add(1);
+            counter.notify_all();
+        }
+    }
+
+    std::unique_ptr<Cell[]> m_cells;
+    std::size_t m_mask;
+    alignas(64) std::atomic<std::size_t> m_enqueuePos{0};
+    alignas(64) std::atomic<std::size_t> m_dequeuePos{0};
+    alignas(64) std::atomic<unsigned int> m_pushCount{0};
+    std::atomic<unsigned int> m_waitingConsumers{0};
+    alignas(64) std::atomic<unsigned int> m_popCount{0};
+    std::atomic<unsigned int> m_waitingProducers{0};
+};
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <utility>
+
+/*
+ * "Publish once, read many": one producer fills in the data, and any number of consumers
+ * wait until the data are published, and then read them in parallel.
+ *
+ * - Waiting works like a latch: consumers sleep on a condition variable until the
+ *   producer has finished. Once published, wait() doesn't touch that mutex any more.
+ * - Reading happens through a Snapshot. Data are published only once, and seeing the
+ *   ready flag with acquire ordering makes them visible, so a Snapshot takes no lock,
+ *   and any number of consumers read in parallel without touching a shared cache line.
+ * - Only if the data are modified after publishing with update(), readers that run at
+ *   the same time must use readLocked(), which takes a shared lock that update() takes
+ *   exclusively.
+ *
+ * Usage:
+ *   SharedPublication<Data> publication;
+ *   // producer
+ *   publication.publish([](Data& data){ data.x = 42; });
+ *   // consumers
+ *   auto snapshot = publication.wait();
+ *   use(snapshot->x);
+ */
+template<typename T>
+class SharedPublication {
+public:
+    // Read-only access to the published data, without a lock
+    class Snapshot {
+    public:
+        const T& operator*() const { return m_data; }
+        const T* operator->() const { return &m_data; }
+
+    private:
+        friend class SharedPublication;
+        explicit Snapshot(const T& data) : m_data(data) { }
+
+        const T& m_data;
+    };
+
+    // Read-only access to the data, which update() can't change while the snapshot exists
+    class LockedSnapshot {
+    public:
+        const T& operator*() const { return m_data; }
+        const T* operator->() const { return &m_data; }
+
+    private:
+        friend class SharedPublication;
+        LockedSnapshot(std::shared_mutex& mutex, const T& data) : m_lock(mutex), m_data(data) { }
+
+        std::shared_lock<std::shared_mutex> m_lock;
+        const T& m_data;
+    };
+
+    // Fill in the data by calling produce(T&), and then wake up all consumers.
+    // Throws std::logic_error if the data were already published.
+    template<typename Function>
+    void publish(Function&& produce) {
+        {
+            // Nobody reads before m_ready is set, so only concurrent publishers are kept out
+            std::scoped_lock lock{m_readyMutex};
+            if (isPublished()) {
+                throw std::logic_error("SharedPublication can only be published once");
+            }
+            std::forward<Function>(produce)(m_data);
+            m_ready.store(true, std::memory_order_release);
+        }
+        m_readyCond.notify_all();
+    }
+
+    // Modify already published data. Waits until no consumer holds a LockedSnapshot.
+    // Readers with a plain Snapshot aren't protected, so don't mix the two.
+    template<typename Function>
+    void update(Function&& modify) {
+        std::unique_lock lock{m_dataMutex};
+        std::forward<Function>(modify)(m_data);
+    }
+
+    bool isPublished() const {
+        return m_ready.load(std::memory_order_acquire);
+    }
+
+    // Block until the data are published, and return a snapshot for reading
+    Snapshot wait() const {
+        waitForPublication();
+        return Snapshot{m_data};
+    }
+
+    // Same as wait(), but the snapshot holds a shared lock, for readers that run while
+    // update() may be called
+    LockedSnapshot readLocked() const {
+        waitForPublication();
+        return LockedSnapshot{m_dataMutex, m_data};
+    }
+
+private:
+    void waitForPublication() const {
+        if (!isPublished()) {
+            std::unique_lock lock{m_readyMutex};
+            m_readyCond.wait(lock, [this](){ return isPublished(); });
+        }
+    }
+
+    T m_data{};
+    mutable std::shared_mutex m_dataMutex;
+    mutable std::mutex m_readyMutex;
+    mutable std::condition_variable m_readyCond;
+    std::atomic<bool> m_ready{false};
+};
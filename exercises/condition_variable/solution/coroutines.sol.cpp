@@ -0,0 +1,87 @@
+#include "Coroutines.hpp"
+#include "../../common/AllocationCounter.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+/*
+ * The producer/consumer flow of condition_variable.cpp with coroutines instead of threads.
+ * One producer prepares the data, thousands of consumers wait for it on one Event, then
+ * process it and send their result through a Channel to a collector.
+ * All of it runs on a single thread.
+ *
+ * To measure how much memory a waiting consumer needs, AllocationCounter.hpp replaces the
+ * global operator new and delete, and counts the bytes that are currently allocated.
+ *
+ * Usage: coroutines.sol [nConsumers]
+ */
+
+using namespace std::chrono_literals;
+
+// A mock data object, as in condition_variable.cpp
+struct Data {
+    bool isReady() const {
+        return _isReady;
+    }
+
+    bool _isReady = false;
+    bool _isConsistent = false;
+};
+
+Task<> consumer(const Data& data, Event& ready, Channel<bool>& results) {
+    co_await ready;
+    // Instead of burning CPU for 5 s, let the other consumers run in between
+    co_await results.send(data._isConsistent);
+}
+
+Task<> producer(Executor& executor, Data& data, Event& ready, std::size_t baseline, unsigned int nConsumers) {
+    std::cout << "[p] Starting to produce data\n";
+    co_await executor.sleepFor(100ms);
+    data._isConsistent = true;
+    data._isReady = true;
+
+    // All consumers are waiting now
+    const std::size_t waiting = allocatedBytes() - baseline;
+    std::cout << "[p] Data ready now. " << nConsumers << " consumers are waiting, using "
+              << waiting << " bytes, " << waiting / nConsumers << " bytes per consumer\n";
+    ready.set();
+}
+
+Task<unsigned int> collect(Channel<bool>& results, unsigned int nConsumers) {
+    unsigned int nOK = 0;
+    for (unsigned int i = 0; i < nConsumers; ++i) {
+        if (auto result = co_await results.receive(); result && *result) ++nOK;
+    }
+    co_return nOK;
+}
+
+Task<> report(Channel<bool>& results, unsigned int nConsumers) {
+    const unsigned int nOK = co_await collect(results, nConsumers);
+    std::cout << nOK << " of " << nConsumers << " consumers completed OK\n";
+}
+
+int main(int argc, char* argv[]) {
+    const int argument = argc > 1 ? std::atoi(argv[1]) : 10000;
+    if (argument <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [nConsumers > 0]\n";
+        return 1;
+    }
+    const unsigned int nConsumers = argument;
+
+    Executor executor;
+    Data data;
+    Event ready{executor};
+    Channel<bool> results{executor, 64};
+    executor.spawn(report(results, nConsumers));
+
+    const std::size_t baseline = allocatedBytes();
+    for (unsigned int i = 0; i < nConsumers; ++i) {
+        executor.spawn(consumer(data, ready, results));
+    }
+    executor.spawn(producer(executor, data, ready, baseline, nConsumers));
+
+    const auto start = std::chrono::steady_clock::now();
+    executor.run();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Done after " << elapsed.count() << " s on one thread\n";
+}
@@ -0,0 +1,111 @@
+#include "HybridMutex.hpp"
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/*
+ * Measure how long a short handoff takes, with std::mutex / std::condition_variable and
+ * with HybridMutex / HybridConditionVariable.
+ *
+ * Like in condition_variable.cpp, a producer marks the data as ready and notifies a
+ * consumer, but here the data are ready after a few microseconds instead of 6 s. We
+ * measure the time from the notification until the consumer runs, and print a histogram.
+ * Then the consumer hands the data back, and the producer starts the next round.
+ */
+
+using Clock = std::chrono::steady_clock;
+
+// Counts latencies in buckets of powers of two nanoseconds
+class LatencyHistogram {
+public:
+    void add(Clock::duration latency) {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count();
+        std::size_t bucket = 0;
+        while (bucket + 1 < m_counts.size() && (1ll << (bucket + 1)) <= ns) ++bucket;
+        ++m_counts[bucket];
+        ++m_total;
+    }
+
+    // Smallest power of two such that the given fraction of latencies is below it
+    long long percentile(double fraction) const {
+        unsigned long long sum = 0;
+        for (std::size_t bucket = 0; bucket < m_counts.size(); ++bucket) {
+            sum += m_counts[bucket];
+            if (sum >= fraction * m_total) return 1ll << (bucket + 1);
+        }
+        return 1ll << m_counts.size();
+    }
+
+    void print(const std::string& name) const {
+        std::cout << name << ": p50 < " << percentile(0.5) << " ns, p99 < "
+                  << percentile(0.99) << " ns\n";
+        for (std::size_t bucket = 0; bucket < m_counts.size(); ++bucket) {
+            if (m_counts[bucket] == 0) continue;
+            std::cout << std::setw(12) << (1ll << bucket) << " ns  " << std::setw(8) << m_counts[bucket] << ' '
+                      << std::string(60 * m_counts[bucket] / m_total, '#') << '\n';
+        }
+    }
+
+private:
+    std::array<unsigned long long, 32> m_counts{};
+    unsigned long long m_total = 0;
+};
+
+// Simulate a short data production phase
+void produce(std::chrono::microseconds duration) {
+    const auto start = Clock::now();
+    while (Clock::now() - start < duration) { }
+}
+
+template<typename Mutex, typename ConditionVariable>
+LatencyHistogram handoff(unsigned int nRounds, std::chrono::microseconds productionTime) {
+    Mutex mutex;
+    ConditionVariable cond;
+    bool ready = false;
+    Clock::time_point notifyTime;
+    LatencyHistogram histogram;
+
+    std::thread consumer([&](){
+        for (unsigned int i = 0; i < nRounds; ++i) {
+            std::unique_lock<Mutex> lock{mutex};
+            cond.wait(lock, [&](){ return ready; });
+            histogram.add(Clock::now() - notifyTime);
+            ready = false;
+            lock.unlock();
+            cond.notify_one();
+        }
+    });
+
+    for (unsigned int i = 0; i < nRounds; ++i) {
+        produce(productionTime);
+        {
+            std::scoped_lock<Mutex> lock{mutex};
+            ready = true;
+            notifyTime = Clock::now();
+        }
+        cond.notify_one();
+        // Wait until the consumer took the data
+        std::unique_lock<Mutex> lock{mutex};
+        cond.wait(lock, [&](){ return !ready; });
+    }
+    consumer.join();
+    return histogram;
+}
+
+int main(int argc, char* argv[]) {
+    const unsigned int nRounds = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const std::chrono::microseconds productionTime{argc > 2 ? std::atoi(argv[2]) : 2};
+    std::cout << nRounds << " handoffs, " << productionTime.count() << " us production time\n\n";
+
+    handoff<std::mutex, std::condition_variable>(nRounds, productionTime)
+        .print("std::mutex + std::condition_variable");
+    std::cout << '\n';
+    handoff<HybridMutex, HybridConditionVariable>(nRounds, productionTime)
+        .print("HybridMutex + HybridConditionVariable");
+}
@@ -0,0 +1,59 @@
+#include "AsyncLogger.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+/*
+ * Several threads log many lines, first with SafeCout from condition_variable.cpp, then
+ * with AsyncCout. We measure how long the threads are busy with logging.
+ * The log lines go to std::cout, and the timings to std::cerr, so run e.g.
+ *   ./logbench.sol > /dev/null
+ */
+
+// Print contents of the stream to cout in a thread-safe manner.
+class SafeCout {
+  std::stringstream stream;
+  inline static std::mutex cout_mutex;
+
+public:
+  ~SafeCout() {
+    std::scoped_lock<std::mutex> coutLock{cout_mutex};
+    std::cout << stream.str();
+  }
+
+  template<typename T>
+  SafeCout & operator<<(T&& arg) {
+    stream << std::forward<T>(arg);
+    return *this;
+  }
+};
+
+constexpr unsigned int nLines = 100000;
+
+template<typename Logger>
+double logFromThreads(unsigned int nThreads) {
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < nThreads; ++t) {
+        threads.emplace_back([t](){
+            for (unsigned int i = 0; i < nLines; ++i) {
+                Logger{} << '[' << t << "] Processing item " << i << " of " << nLines
+                         << ", progress " << 100. * i / nLines << "%\n";
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (nThreads * nLines);
+}
+
+int main(int argc, char* argv[]) {
+    const unsigned int nThreads = argc > 1 ? std::atoi(argv[1]) : 4;
+    const double safe = logFromThreads<SafeCout>(nThreads);
+    const double async = logFromThreads<AsyncCout>(nThreads);
+    std::cerr << nThreads << " threads:\tSafeCout " << safe << " ns/line\tAsyncCout " << async << " ns/line\n";
+}
@@ -0,0 +1,94 @@
+#include "SharedPublication.hpp"
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+/*
+ * The producer/multi-consumer example from condition_variable.cpp, written with
+ * SharedPublication. The producer publishes the data once, and all consumers then
+ * process them in parallel with read-only access. Check with top that you reach 400%.
+ */
+using namespace std::chrono_literals;
+
+// Print contents of the stream to cout in a thread-safe manner.
+class SafeCout {
+  std::stringstream stream;
+  inline static std::mutex cout_mutex;
+
+public:
+  ~SafeCout() {
+    std::scoped_lock<std::mutex> coutLock{cout_mutex};
+    std::cout << stream.str();
+  }
+
+  template<typename T>
+  SafeCout & operator<<(T&& arg) {
+    stream << std::forward<T>(arg);
+    return *this;
+  }
+};
+
+// A mock data object
+struct Data {
+  bool _isConsistent = false;
+};
+
+// Check whether the data are consistent, and burn some CPU to simulate processing
+bool process(unsigned int threadIdx, Data const & data) {
+  bool processingOK = true;
+
+  SafeCout{} << '[' << threadIdx << "] I'm starting to process the data now\n";
+  if (!data._isConsistent) {
+    processingOK = false;
+    SafeCout{} << '[' << threadIdx << "] ERROR data isn't fully ready! Race condition!\n";
+  }
+
+  const auto startTime = std::chrono::high_resolution_clock::now();
+  unsigned dummyCounter = 0;
+  while (std::chrono::high_resolution_clock::now() - startTime < 5s) {
+    ++dummyCounter;
+  }
+  return processingOK;
+}
+
+
+int main() {
+  SharedPublication<Data> publication;
+
+  // DATA-PROCESSING THREADS
+  auto processData = [&](unsigned int threadIdx){
+    SafeCout{} << '[' << threadIdx << "] I'm starting to wait\n";
+
+    // All consumers hold a snapshot at the same time
+    auto data = publication.wait();
+    auto result = process(threadIdx, *data);
+
+    SafeCout{} << '[' << threadIdx << "] Data processing completed " << (result ? "OK" : "with failure!") << '\n';
+  };
+
+  std::vector<std::thread> consumers;
+  for (unsigned int i=0; i < 4; ++i) {
+    consumers.emplace_back(processData, i);
+  }
+
+  // DATA-PRODUCER THREAD
+  std::thread producer([&](){
+    SafeCout{} << "[p] Starting to produce data\n";
+    publication.publish([](Data & data){
+      // Sleep a bit to simulate a complicated set up phase
+      std::this_thread::sleep_for(6s);
+      data._isConsistent = true;
+    });
+    SafeCout{} << "[p] Data ready now\n";
+  });
+
+  producer.join();
+  for (auto & t : consumers) {
+    t.join();
+  }
+
+  return 0;
+}
@@ -0,0 +1,91 @@
+#include "MPMCQueue.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/*
+ * Compare the throughput of the lock-free MPMCQueue with a bounded queue protected by a
+ * std::mutex and two std::condition_variables, as we used them in condition_variable.cpp.
+ * We use the same number of producer and consumer threads, from 1+1 up to 16+16 (or the
+ * maximum given as argument).
+ */
+
+// The classic bounded queue with a lock
+template<typename T>
+class MutexQueue {
+public:
+    explicit MutexQueue(std::size_t capacity) : m_capacity(capacity) { }
+
+    void push(T value) {
+        {
+            std::unique_lock lock{m_mutex};
+            m_notFull.wait(lock, [this](){ return m_queue.size() < m_capacity; });
+            m_queue.push(std::move(value));
+        }
+        m_notEmpty.notify_one();
+    }
+
+    T pop() {
+        T value;
+        {
+            std::unique_lock lock{m_mutex};
+            m_notEmpty.wait(lock, [this](){ return !m_queue.empty(); });
+            value = std::move(m_queue.front());
+            m_queue.pop();
+        }
+        m_notFull.notify_one();
+        return value;
+    }
+
+private:
+    std::size_t m_capacity;
+    std::queue<T> m_queue;
+    std::mutex m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+};
+
+constexpr unsigned int nItems = 1 << 20;
+constexpr std::size_t capacity = 1024;
+
+template<typename Queue>
+double itemsPerSecond(unsigned int nThreads) {
+    Queue queue(capacity);
+    const unsigned int itemsPerThread = nItems / nThreads;
+    std::vector<unsigned long> sums(nThreads);
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < nThreads; ++t) {
+        threads.emplace_back([&queue, itemsPerThread](){
+            for (unsigned int i = 0; i < itemsPerThread; ++i) queue.push(i);
+        });
+        threads.emplace_back([&queue, &sums, itemsPerThread, t](){
+            for (unsigned int i = 0; i < itemsPerThread; ++i) sums[t] += queue.pop();
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    // Every item was received exactly once
+    unsigned long total = 0;
+    for (auto sum : sums) total += sum;
+    const unsigned long expected = nThreads * (itemsPerThread * (itemsPerThread - 1ul) / 2);
+    if (total != expected) std::cerr << "Items were lost or duplicated!\n";
+
+    return nThreads * itemsPerThread / elapsed.count();
+}
+
+int main(int argc, char* argv[]) {
+    const unsigned int maxThreads = argc > 1 ? std::atoi(argv[1]) : 16;
+    std::cout << "producers+consumers\tmutex+condvar [items/s]\tlock-free [items/s]\n";
+    for (unsigned int n = 1; n <= maxThreads; n *= 2) {
+        std::cout << n << '+' << n << "\t\t\t" << itemsPerSecond<MutexQueue<unsigned int>>(n)
+                  << "\t\t\t" << itemsPerSecond<MPMCQueue<unsigned int>>(n) << '\n';
+    }
+}
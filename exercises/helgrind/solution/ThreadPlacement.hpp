@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <filesystem>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/*
+ * Control on which CPUs worker threads run.
+ *
+ * Normally, the operating system may move a thread to another core at any time. The
+ * thread then finds its data in the caches of the old core, or even in the memory of the
+ * other socket. Pinning workers to fixed cores avoids that, and makes timings more stable.
+ *
+ * - CpuTopology::query() lists the CPUs that this process may use, with their core,
+ *   package (socket) and NUMA node.
+ * - launchWorkers(n, placement, work) starts n threads, pins them according to the
+ *   placement, and calls work(WorkerInfo) on each of them.
+ * - PerWorker<T> holds one object per worker. If each worker creates its object itself
+ *   (after it was pinned), Linux places the memory on the worker's NUMA node, because
+ *   pages are allocated on the node of the thread that first touches them.
+ *
+ * Pinning is only implemented for Linux. Elsewhere, threads are started without placement.
+ */
+
+struct CpuInfo {
+    unsigned int id;        // the number the operating system uses
+    unsigned int core;      // CPUs with the same package and core are hyperthreads
+    unsigned int package;
+    unsigned int node;      // NUMA node
+};
+
+class CpuTopology {
+public:
+    static CpuTopology query();
+
+    const std::vector<CpuInfo>& cpus() const { return m_cpus; }
+
+    unsigned int numberOfNodes() const {
+        unsigned int n = 0;
+        for (const auto& cpu : m_cpus) n = std::max(n, cpu.node + 1);
+        return n;
+    }
+
+    unsigned int numberOfPackages() const {
+        unsigned int n = 0;
+        for (const auto& cpu : m_cpus) n = std::max(n, cpu.package + 1);
+        return n;
+    }
+
+    // Physical cores, counting hyperthreads only once
+    unsigned int numberOfCores() const {
+        std::vector<std::pair<unsigned int, unsigned int>> cores;
+        for (const auto& cpu : m_cpus) cores.emplace_back(cpu.package, cpu.core);
+        std::sort(cores.begin(), cores.end());
+        return static_cast<unsigned int>(std::unique(cores.begin(), cores.end()) - cores.begin());
+    }
+
+private:
+    std::vector<CpuInfo> m_cpus;
+};
+
+enum class Placement {
+    None,      // let the operating system decide
+    Compact,   // fill one NUMA node after the other, to share caches
+    Scatter    // spread over NUMA nodes and physical cores first, for memory bandwidth
+};
+
+struct WorkerInfo {
+    unsigned int index;
+    const CpuInfo* cpu;     // nullptr if the worker isn't pinned
+};
+
+namespace placement_detail {
+    inline unsigned int readNumber(const std::string& fileName, unsigned int fallback) {
+        std::ifstream file(fileName);
+        unsigned int value;
+        return file >> value ? value : fallback;
+    }
+
+    // Number of the CPU among the hyperthreads of its core: 0, 1, ...
+    inline unsigned int smtIndex(const std::vector<CpuInfo>& cpus, const CpuInfo& cpu) {
+        return static_cast<unsigned int>(std::count_if(cpus.begin(), cpus.end(), [&](const CpuInfo& other){
+            return other.package == cpu.package && other.core == cpu.core && other.id < cpu.id;
+        }));
+    }
+}
+
+inline CpuTopology CpuTopology::query() {
+    CpuTopology topology;
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        using placement_detail::readNumber;
+        for (unsigned int id = 0; id < CPU_SETSIZE; ++id) {
+            if (!CPU_ISSET(id, &allowed)) continue;
+            const std::string dir = "/sys/devices/system/cpu/cpu" + std::to_string(id);
+            CpuInfo cpu{id, readNumber(dir + "/topology/core_id", id),
+                        readNumber(dir + "/topology/physical_package_id", 0), 0};
+            // The node is given as a link called nodeN in the directory of the CPU
+            std::error_code error;
+            for (const auto& entry : std::filesystem::directory_iterator(dir, error)) {
+                const std::string name = entry.path().filename().string();
+                if (name.size() > 4 && name.compare(0, 4, "node") == 0) {
+                    cpu.node = static_cast<unsigned int>(std::stoul(name.substr(4)));
+                }
+            }
+            topology.m_cpus.push_back(cpu);
+        }
+    }
+#endif
+    if (topology.m_cpus.empty()) {
+        const unsigned int n = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int id = 0; id < n; ++id) topology.m_cpus.push_back({id, id, 0, 0});
+    }
+    return topology;
+}
+
+// The order in which workers are assigned to CPUs. Worker i runs on order[i % order.size()].
+inline std::vector<CpuInfo> placementOrder(const CpuTopology& topology, Placement placement) {
+    using placement_detail::smtIndex;
+    const auto& cpus = topology.cpus();
+    std::vector<CpuInfo> order;
+    if (placement == Placement::Compact) {
+        order = cpus;
+        std::sort(order.begin(), order.end(), [&](const CpuInfo& a, const CpuInfo& b){
+            return std::tuple(a.node, a.package, a.core, smtIndex(cpus, a)) <
+                   std::tuple(b.node, b.package, b.core, smtIndex(cpus, b));
+        });
+    } else if (placement == Placement::Scatter) {
+        // Per node, physical cores before their hyperthreads. Then take one CPU of every
+        // node in turn.
+        std::vector<std::vector<CpuInfo>> nodes(topology.numberOfNodes());
+        for (const auto& cpu : cpus) nodes[cpu.node].push_back(cpu);
+        for (auto& node : nodes) {
+            std::sort(node.begin(), node.end(), [&](const CpuInfo& a, const CpuInfo& b){
+                return std::tuple(smtIndex(cpus, a), a.package, a.core) <
+                       std::tuple(smtIndex(cpus, b), b.package, b.core);
+            });
+        }
+        for (std::size_t i = 0; order.size() < cpus.size(); ++i) {
+            for (const auto& node : nodes) {
+                if (i < node.size()) order.push_back(node[i]);
+            }
+        }
+    }
+    return order;
+}
+
+// Pin the calling thread to one CPU. Returns false if that's not possible.
+inline bool pinCurrentThread(unsigned int cpuId) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpuId, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpuId;
+    return false;
+#endif
+}
+
+// Start n threads that call work(WorkerInfo). The threads have to be joined by the caller.
+template<typename Work>
+std::vector<std::thread> launchWorkers(unsigned int n, Placement placement, Work work,
+                                       const CpuTopology& topology = CpuTopology::query()) {
+    // Shared by all workers, so their CpuInfo pointers stay valid while they run
+    auto order = std::make_shared<const std::vector<CpuInfo>>(placementOrder(topology, placement));
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < n; ++i) {
+        threads.emplace_back([order, work, i](){
+            const CpuInfo* cpu = nullptr;
+            if (!order->empty()) {
+                cpu = &(*order)[i % order->size()];
+                // Pin before the worker touches any memory, so its data end up on its node
+                if (!pinCurrentThread(cpu->id)) cpu = nullptr;
+            }
+            work(WorkerInfo{i, cpu});
+        });
+    }
+    return threads;
+}
+
+// One object per worker, each on its own cache lines. Workers should create their own
+// object with emplace(), so it is allocated on their NUMA node.
+template<typename T>
+class PerWorker {
+    struct alignas(64) Slot {
+        std::unique_ptr<T> object;
+    };
+
+public:
+    explicit PerWorker(unsigned int nWorkers) : m_slots(nWorkers) { }
+
+    template<typename... Args>
+    T& emplace(unsigned int worker, Args&&... args) {
+        m_slots[worker].object = std::make_unique<T>(std::forward<Args>(args)...);
+        return *m_slots[worker].object;
+    }
+
+    T& operator[](unsigned int worker) { return *m_slots[worker].object; }
+    const T& operator[](unsigned int worker) const { return *m_slots[worker].object; }
+
+    std::size_t size() const { return m_slots.size(); }
+
+private:
+    std::vector<Slot> m_slots;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/*
+ * A fixed-size pool of worker threads with a task queue.
+ *
+ * The threads are started once in the constructor, and then pick tasks from the queue.
+ * submit() returns a std::future for the result of the task, so the caller can go on
+ * submitting more work and collect the results later.
+ * The destructor finishes all queued tasks before joining the workers.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned int nThreads = std::thread::hardware_concurrency()) {
+        if (nThreads == 0) nThreads = 1;
+        for (unsigned int i = 0; i < nThreads; ++i) {
+            m_workers.emplace_back([this](){ workerLoop(); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::scoped_lock lock{m_mutex};
+            m_stop = true;
+        }
+        m_cond.notify_all();
+        for (auto& worker : m_workers) worker.join();
+    }
+
+    std::size_t size() const { return m_workers.size(); }
+
+    template<typename Function, typename... Args>
+    auto submit(Function&& f, Args&&... args) {
+        using Result = std::invoke_result_t<Function, Args...>;
+        // std::function needs to be copyable, but packaged_task is move-only,
+        // so we keep the task in a shared_ptr.
+        auto task = std::make_shared<std::packaged_task<Result()>>(
+            std::bind(std::forward<Function>(f), std::forward<Args>(args)...));
+        std::future<Result> result = task->get_future();
+        {
+            std::scoped_lock lock{m_mutex};
+            m_tasks.emplace([task](){ (*task)(); });
+        }
+        m_cond.notify_one();
+        return result;
+    }
+
+private:
+    void workerLoop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock lock{m_mutex};
+                m_cond.wait(lock, [this](){ return m_stop || !m_tasks.empty(); });
+                if (m_tasks.empty()) return; // stopping, and nothing left to do
+                task = std::move(m_tasks.front());
+                m_tasks.pop();
+            }
+            // Run the task without holding the lock
+            task();
+        }
+    }
+
+    std::vector<std::thread> m_workers;
+    std::queue<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_stop = false;
+};
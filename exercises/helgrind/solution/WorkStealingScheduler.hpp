@@ -0,0 +1,284 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/*
+ * A work-stealing scheduler for fork-join parallelism, e.g. recursive divide and conquer.
+ *
+ * Every worker owns a Chase-Lev deque. It pushes and pops new tasks at the bottom of its
+ * own deque without any lock, which keeps the hot path cheap and cache friendly. Idle
+ * workers steal the oldest (and therefore usually largest) task from the top of a random
+ * victim's deque.
+ *
+ * Usage:
+ *   WorkStealingScheduler scheduler(8);
+ *   scheduler.run([&]{
+ *       TaskGroup group;
+ *       group.spawn([&]{ a = work(...); });   // might run on another thread
+ *       b = work(...);                        // continue on this thread
+ *       group.sync();                         // wait for the spawned tasks
+ *   });
+ *
+ * While waiting in sync(), a worker executes other tasks instead of blocking.
+ * Tasks must not throw.
+ */
+
+// A lock-free work-stealing deque (Chase & Lev 2005, with the memory orderings of
+// Le et al. 2013). Only the owner calls push() and pop(); any thread may call steal().
+template<typename T>
+class ChaseLevDeque {
+    struct Array {
+        explicit Array(std::int64_t capacity)
+          : capacity(capacity), slots(std::make_unique<std::atomic<T*>[]>(capacity)) { }
+
+        T* get(std::int64_t i) const { return slots[i & (capacity - 1)].load(std::memory_order_relaxed); }
+        void put(std::int64_t i, T* x) { slots[i & (capacity - 1)].store(x, std::memory_order_relaxed); }
+
+        std::int64_t capacity; // always a power of 2
+        std::unique_ptr<std::atomic<T*>[]> slots;
+    };
+
+public:
+    explicit ChaseLevDeque(std::int64_t capacity = 1024) {
+        m_arrays.push_back(std::make_unique<Array>(capacity));
+        m_array.store(m_arrays.back().get(), std::memory_order_relaxed);
+    }
+
+    void push(T* x) {
+        const std::int64_t b = m_bottom.load(std::memory_order_relaxed);
+        const std::int64_t t = m_top.load(std::memory_order_acquire);
+        Array* a = m_array.load(std::memory_order_relaxed);
+        if (b - t > a->capacity - 1) {
+            a = grow(a, t, b);
+        }
+        a->put(b, x);
+        m_bottom.store(b + 1, std::memory_order_release);
+    }
+
+    // Take the newest element. Returns nullptr if empty.
+    T* pop() {
+        const std::int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+        Array* a = m_array.load(std::memory_order_relaxed);
+        m_bottom.store(b, std::memory_order_seq_cst);
+        std::int64_t t = m_top.load(std::memory_order_seq_cst);
+        if (t > b) {
+            // Empty
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T* x = a->get(b);
+        if (t == b) {
+            // Last element: race against thieves for it
+            if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                x = nullptr;
+            }
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return x;
+    }
+
+    // Take the oldest element. Returns nullptr if empty or if another thread was faster.
+    T* steal() {
+        std::int64_t t = m_top.load(std::memory_order_seq_cst);
+        const std::int64_t b = m_bottom.load(std::memory_order_seq_cst);
+        if (t >= b) {
+            return nullptr;
+        }
+        Array* a = m_array.load(std::memory_order_acquire);
+        T* x = a->get(t);
+        if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return x;
+    }
+
+private:
+    Array* grow(Array* old, std::int64_t t, std::int64_t b) {
+        auto bigger = std::make_unique<Array>(2 * old->capacity);
+        for (std::int64_t i = t; i < b; ++i) {
+            bigger->put(i, old->get(i));
+        }
+        // Thieves may still read from the old array, so we keep it until the deque dies
+        m_arrays.push_back(std::move(bigger));
+        Array* a = m_arrays.back().get();
+        m_array.store(a, std::memory_order_release);
+        return a;
+    }
+
+    alignas(64) std::atomic<std::int64_t> m_top{0};
+    alignas(64) std::atomic<std::int64_t> m_bottom{0};
+    std::atomic<Array*> m_array;
+    std::vector<std::unique_ptr<Array>> m_arrays;
+};
+
+class TaskGroup;
+
+class WorkStealingScheduler {
+public:
+    struct Task {
+        std::function<void()> function;
+        TaskGroup* group;
+    };
+
+    explicit WorkStealingScheduler(unsigned int nThreads = std::thread::hardware_concurrency())
+      : m_deques(nThreads == 0 ? 1 : nThreads) {
+        // The thread calling run() is worker 0, so we start one thread less
+        for (unsigned int i = 1; i < m_deques.size(); ++i) {
+            m_threads.emplace_back([this, i](){ workerLoop(i); });
+        }
+    }
+
+    WorkStealingScheduler(const WorkStealingScheduler&) = delete;
+    WorkStealingScheduler& operator=(const WorkStealingScheduler&) = delete;
+
+    ~WorkStealingScheduler() {
+        {
+            std::scoped_lock lock{m_mutex};
+            m_stop = true;
+        }
+        m_cond.notify_all();
+        for (auto& thread : m_threads) thread.join();
+    }
+
+    std::size_t size() const { return m_deques.size(); }
+
+    // Run the root task on the calling thread, with all workers helping.
+    // Returns when the root task is done.
+    void run(const std::function<void()>& root) {
+        {
+            std::scoped_lock lock{m_mutex};
+            m_active = true;
+        }
+        m_cond.notify_all();
+        t_scheduler = this;
+        t_index = 0;
+        root();
+        t_scheduler = nullptr;
+        std::scoped_lock lock{m_mutex};
+        m_active = false;
+    }
+
+    // Push a task to the deque of the calling worker
+    static void spawn(Task* task) {
+        if (!t_scheduler) {
+            throw std::logic_error("Tasks can only be spawned inside WorkStealingScheduler::run");
+        }
+        t_scheduler->m_deques[t_index].push(task);
+    }
+
+    // Run one task from the own deque or a stolen one. Returns false if none was found.
+    static bool runOneTask() {
+        if (!t_scheduler) return false;   // not inside run(), so there are no tasks either
+        Task* task = t_scheduler->findTask();
+        if (!task) return false;
+        execute(task);
+        return true;
+    }
+
+private:
+    static void execute(Task* task);
+
+    Task* findTask() {
+        if (Task* task = m_deques[t_index].pop()) {
+            return task;
+        }
+        // Try to steal from a random victim
+        thread_local std::minstd_rand random{static_cast<unsigned int>(t_index + 1)};
+        const auto n = m_deques.size();
+        if (n == 1) return nullptr;
+        const std::size_t start = random() % n;
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::size_t victim = (start + i) % n;
+            if (victim == t_index) continue;
+            if (Task* task = m_deques[victim].steal()) {
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    void workerLoop(unsigned int index) {
+        t_scheduler = this;
+        t_index = index;
+        while (!m_stop.load(std::memory_order_relaxed)) {
+            if (!m_active.load(std::memory_order_acquire)) {
+                // Sleep while there is no run() going on
+                std::unique_lock lock{m_mutex};
+                m_cond.wait(lock, [this](){ return m_stop || m_active; });
+                continue;
+            }
+            if (!runOneTask()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    std::vector<ChaseLevDeque<Task>> m_deques;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::atomic<bool> m_active{false};
+    std::atomic<bool> m_stop{false};
+
+    inline static thread_local WorkStealingScheduler* t_scheduler = nullptr;
+    inline static thread_local std::size_t t_index = 0;
+};
+
+// A set of spawned tasks that can be waited for
+class TaskGroup {
+public:
+    TaskGroup() = default;
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    ~TaskGroup() {
+        sync();
+    }
+
+    // Throws std::logic_error outside of WorkStealingScheduler::run
+    template<typename Function>
+    void spawn(Function&& f) {
+        auto task = std::make_unique<WorkStealingScheduler::Task>(
+            WorkStealingScheduler::Task{std::forward<Function>(f), this});
+        // Count the task before pushing it, because a thief may run it right away.
+        // If the push fails, nothing was published, so we can take the count back.
+        m_pending.fetch_add(1, std::memory_order_relaxed);
+        try {
+            WorkStealingScheduler::spawn(task.get());
+        } catch (...) {
+            m_pending.fetch_sub(1, std::memory_order_relaxed);
+            throw;
+        }
+        task.release();   // now owned by the deque
+    }
+
+    // Wait until all spawned tasks are done, and help executing tasks meanwhile
+    void sync() {
+        while (m_pending.load(std::memory_order_acquire) != 0) {
+            if (!WorkStealingScheduler::runOneTask()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    friend class WorkStealingScheduler;
+    std::atomic<unsigned int> m_pending{0};
+};
+
+inline void WorkStealingScheduler::execute(Task* task) {
+    task->function();
+    // Destroy the task's captures before sync() can return and its caller's frame unwind
+    TaskGroup* group = task->group;
+    delete task;
+    group->m_pending.fetch_sub(1, std::memory_order_release);
+}
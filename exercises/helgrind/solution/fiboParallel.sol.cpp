@@ -0,0 +1,57 @@
+#include "WorkStealingScheduler.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+/*
+ * The recursive fibo() spawns one of its two sub-computations as a task, and computes
+ * the other one itself. Below the grain size, it falls back to the serial recursion, so
+ * we don't flood the deques with tiny tasks.
+ *
+ * We print the speedup for 1, 2, 4, ... threads up to the number of cores. Usage:
+ *   ./fiboParallel.sol [n] [maxThreads] [grainSize]
+ */
+
+unsigned long fibo(unsigned a) {
+    if (a == 1 || a == 0) {
+        return 1;
+    } else {
+        return fibo(a-1)+fibo(a-2);
+    }
+}
+
+unsigned long parallelFibo(unsigned a, unsigned grainSize) {
+    if (a < grainSize) {
+        return fibo(a);
+    }
+    unsigned long x = 0;
+    TaskGroup group;
+    group.spawn([&x, a, grainSize](){ x = parallelFibo(a-1, grainSize); });
+    const unsigned long y = parallelFibo(a-2, grainSize);
+    group.sync();
+    return x + y;
+}
+
+int main(int argc, char* argv[]) {
+    const unsigned int n = argc > 1 ? std::atoi(argv[1]) : 40;
+    const unsigned int maxThreads = argc > 2 ? std::atoi(argv[2]) : std::thread::hardware_concurrency();
+    const unsigned int grainSize = argc > 3 ? std::atoi(argv[3]) : 25;
+
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    const unsigned long reference = fibo(n);
+    const std::chrono::duration<double> serialTime = Clock::now() - start;
+    std::cout << "fibo(" << n << ") = " << reference << ", serial: " << serialTime.count() << " s\n";
+    std::cout << "threads\ttime [s]\tspeedup\n";
+
+    for (unsigned int nThreads = 1; nThreads <= std::max(1u, maxThreads); nThreads *= 2) {
+        WorkStealingScheduler scheduler(nThreads);
+        unsigned long result = 0;
+        start = Clock::now();
+        scheduler.run([&](){ result = parallelFibo(n, grainSize); });
+        const std::chrono::duration<double> time = Clock::now() - start;
+        std::cout << nThreads << '\t' << time.count() << "\t\t" << serialTime / time
+                  << (result == reference ? "" : "\tWRONG RESULT") << '\n';
+    }
+}
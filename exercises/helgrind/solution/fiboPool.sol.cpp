@@ -0,0 +1,100 @@
+#include "ThreadPool.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+ * Like fiboMT, but all computations are submitted to a thread pool. The threads are only
+ * created once, and all WorkToDo items are in flight at the same time. Once everything is
+ * submitted, we collect the results through their futures in the order in which the tasks
+ * complete: every task reports its index to a completion queue when it's done.
+ */
+
+constexpr auto NBITERATIONS = 20;
+constexpr auto MIN = 22;
+constexpr auto MAX = 30;
+
+struct WorkToDo {
+    std::string title;
+    int a;
+};
+
+unsigned int fibo(unsigned a) {
+    if (a == 1 || a == 0) {
+        return 1;
+    } else {
+        return fibo(a-1)+fibo(a-2);
+    }
+}
+
+// Indices of the tasks that are done, in the order in which they finished
+class CompletionQueue {
+public:
+    void push(unsigned int index) {
+        {
+            std::scoped_lock lock{m_mutex};
+            m_done.push(index);
+        }
+        m_cond.notify_one();
+    }
+
+    unsigned int pop() {
+        std::unique_lock lock{m_mutex};
+        m_cond.wait(lock, [this](){ return !m_done.empty(); });
+        const unsigned int index = m_done.front();
+        m_done.pop();
+        return index;
+    }
+
+private:
+    std::queue<unsigned int> m_done;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+};
+
+// The task owns its WorkToDo, so nobody can free the title while it is in use
+std::future<unsigned long> launchFibo(ThreadPool& pool, WorkToDo work, unsigned int index,
+                                      CompletionQueue& completions) {
+    std::cout << "Computing " << work.title << '\n';
+    return pool.submit([work = std::move(work), index, &completions]() -> unsigned long {
+        const unsigned long result = fibo(work.a);
+        completions.push(index);
+        return result;
+    });
+}
+
+int main() {
+    const auto start = std::chrono::steady_clock::now();
+    ThreadPool pool;
+    std::default_random_engine e;
+    std::uniform_int_distribution d{MIN, MAX};
+
+    CompletionQueue completions;
+    std::vector<std::string> titles;
+    std::vector<std::future<unsigned long>> results;
+    for (unsigned int i = 0; i < NBITERATIONS; i++) {
+        unsigned int a = d(e);
+        std::stringstream ss;
+        ss << "Fibo(" << a << ")";
+        titles.push_back(ss.str());
+        results.push_back(launchFibo(pool, WorkToDo{ss.str(), static_cast<int>(a)}, i, completions));
+    }
+
+    // Print every result as soon as it's there. The task reports itself just before it
+    // returns, so get() waits at most for the pool to store the result in the future.
+    for (unsigned int n = 0; n < NBITERATIONS; n++) {
+        const unsigned int i = completions.pop();
+        std::cout << titles[i] << " = " << results[i].get() << '\n';
+    }
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Computed " << NBITERATIONS << " numbers on " << pool.size() << " threads in "
+              << elapsed.count() << " s\n";
+}
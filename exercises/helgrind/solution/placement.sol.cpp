@@ -0,0 +1,68 @@
+#include "ThreadPlacement.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+/*
+ * Run the same memory-bound work a few times with every Placement, and print the mean
+ * run time and its spread. Each worker allocates and fills its own array after it was
+ * pinned, so the array is on the worker's NUMA node.
+ *
+ * Usage: placement.sol [nWorkers] [nRepetitions]
+ */
+
+constexpr std::size_t elementsPerWorker = 1 << 22;
+constexpr unsigned int nPasses = 20;
+
+double runOnce(unsigned int nWorkers, Placement placement, const CpuTopology& topology) {
+    PerWorker<std::vector<unsigned int>> data(nWorkers);
+    std::vector<unsigned long> sums(nWorkers);
+
+    const auto start = std::chrono::steady_clock::now();
+    auto threads = launchWorkers(nWorkers, placement, [&](WorkerInfo worker){
+        auto& array = data.emplace(worker.index, elementsPerWorker);
+        std::iota(array.begin(), array.end(), worker.index);
+        unsigned long sum = 0;
+        for (unsigned int pass = 0; pass < nPasses; ++pass) {
+            for (auto& x : array) {
+                x = x * 3 + 1;
+                sum += x;
+            }
+        }
+        sums[worker.index] = sum;
+    }, topology);
+    for (auto& thread : threads) thread.join();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+int main(int argc, char* argv[]) {
+    const CpuTopology topology = CpuTopology::query();
+    const unsigned int nWorkers = argc > 1 ? std::atoi(argv[1]) : topology.cpus().size();
+    const unsigned int nRepetitions = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    std::cout << topology.cpus().size() << " CPUs, " << topology.numberOfCores() << " cores, "
+              << topology.numberOfPackages() << " packages, " << topology.numberOfNodes() << " NUMA nodes\n";
+    for (const auto& cpu : topology.cpus()) {
+        std::cout << "  cpu " << cpu.id << ": core " << cpu.core << ", package " << cpu.package
+                  << ", node " << cpu.node << '\n';
+    }
+    std::cout << nWorkers << " workers, " << nRepetitions << " repetitions\n";
+
+    const std::pair<const char*, Placement> placements[] = {
+        {"none", Placement::None}, {"compact", Placement::Compact}, {"scatter", Placement::Scatter}};
+    for (const auto& [name, placement] : placements) {
+        std::vector<double> times;
+        for (unsigned int i = 0; i < nRepetitions; ++i) {
+            times.push_back(runOnce(nWorkers, placement, topology));
+        }
+        const double mean = std::accumulate(times.begin(), times.end(), 0.) / times.size();
+        double variance = 0.;
+        for (double t : times) variance += (t - mean) * (t - mean);
+        const double sigma = std::sqrt(variance / times.size());
+        std::cout << name << ":\t" << mean << " s +- " << sigma << " s\n";
+    }
+}
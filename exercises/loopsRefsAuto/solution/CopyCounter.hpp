@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+
+/*
+ * Count how often objects of a type are copied, moved and destroyed.
+ *
+ * Derive from CopyCounted<YourType> (the type is only used to keep separate counts):
+ *   struct DontCopyMe : CopyCounted<DontCopyMe> { ... };
+ * Implicitly generated copy and move operations count automatically. A hand-written copy
+ * constructor has to copy the base class, too:
+ *   DontCopyMe(const DontCopyMe& other) : CopyCounted(other), ... { }
+ *
+ * CopyCounted<T>::counts() returns the numbers so far. A CopyBudget checks that a piece of
+ * code doesn't copy more than allowed, and calls copyBudgetExceeded otherwise, which
+ * aborts the program by default, so a test fails:
+ *   {
+ *     CopyBudget<DontCopyMe> budget{0, "analysis loop"};
+ *     for (auto const & item : collection) { ... }
+ *   }
+ *
+ * Counting is switched off when NDEBUG is defined (release builds), unless COPY_COUNTING
+ * is defined to 1. CopyCounted and CopyBudget are then empty classes without any code,
+ * counts() are all zero, and budgets are never exceeded.
+ */
+
+#ifndef COPY_COUNTING
+#ifdef NDEBUG
+#define COPY_COUNTING 0
+#else
+#define COPY_COUNTING 1
+#endif
+#endif
+
+struct CopyCounts {
+    std::size_t copyConstructions = 0;
+    std::size_t copyAssignments = 0;
+    std::size_t moveConstructions = 0;
+    std::size_t moveAssignments = 0;
+    std::size_t destructions = 0;
+
+    std::size_t copies() const { return copyConstructions + copyAssignments; }
+    std::size_t moves() const { return moveConstructions + moveAssignments; }
+};
+
+inline std::ostream& operator<<(std::ostream& os, const CopyCounts& counts) {
+    return os << counts.copyConstructions << " copy constructions, "
+              << counts.copyAssignments << " copy assignments, "
+              << counts.moveConstructions << " move constructions, "
+              << counts.moveAssignments << " move assignments, "
+              << counts.destructions << " destructions";
+}
+
+#if COPY_COUNTING
+
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+
+template<typename Tag>
+class CopyCounted {
+public:
+    static CopyCounts counts() {
+        CopyCounts result;
+        result.copyConstructions = s_copyConstructions.load(std::memory_order_relaxed);
+        result.copyAssignments = s_copyAssignments.load(std::memory_order_relaxed);
+        result.moveConstructions = s_moveConstructions.load(std::memory_order_relaxed);
+        result.moveAssignments = s_moveAssignments.load(std::memory_order_relaxed);
+        result.destructions = s_destructions.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    CopyCounted() = default;
+    CopyCounted(const CopyCounted&) { count(s_copyConstructions); }
+    CopyCounted(CopyCounted&&) noexcept { count(s_moveConstructions); }
+    CopyCounted& operator=(const CopyCounted&) { count(s_copyAssignments); return *this; }
+    CopyCounted& operator=(CopyCounted&&) noexcept { count(s_moveAssignments); return *this; }
+    ~CopyCounted() { count(s_destructions); }
+
+private:
+    // Relaxed atomics, so objects can be copied in several threads
+    static void count(std::atomic<std::size_t>& counter) {
+        counter.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    inline static std::atomic<std::size_t> s_copyConstructions{0};
+    inline static std::atomic<std::size_t> s_copyAssignments{0};
+    inline static std::atomic<std::size_t> s_moveConstructions{0};
+    inline static std::atomic<std::size_t> s_moveAssignments{0};
+    inline static std::atomic<std::size_t> s_destructions{0};
+};
+
+// Called when a CopyBudget is exceeded. Tests may replace it, e.g. to throw.
+inline std::function<void(const char* scope, std::size_t copies, std::size_t budget)> copyBudgetExceeded =
+    [](const char* scope, std::size_t copies, std::size_t budget) {
+        std::cerr << "Copy budget exceeded in " << scope << ": " << copies
+                  << " copies, but only " << budget << " allowed\n";
+        std::abort();
+    };
+
+// Checks at the end of a scope that objects of type T were copied at most maxCopies times.
+// scope names the checked code in the message, and must outlive the budget.
+template<typename T>
+class CopyBudget {
+public:
+    CopyBudget(std::size_t maxCopies, const char* scope)
+      : m_maxCopies(maxCopies), m_scope(scope), m_before(T::counts()) { }
+
+    CopyBudget(const CopyBudget&) = delete;
+    CopyBudget& operator=(const CopyBudget&) = delete;
+
+    ~CopyBudget() {
+        const std::size_t n = copies();
+        if (n > m_maxCopies) copyBudgetExceeded(m_scope, n, m_maxCopies);
+    }
+
+    // Copies since the budget was created
+    std::size_t copies() const {
+        return T::counts().copies() - m_before.copies();
+    }
+
+private:
+    std::size_t m_maxCopies;
+    const char* m_scope;
+    CopyCounts m_before;
+};
+
+#else
+
+template<typename Tag>
+class CopyCounted {
+public:
+    static CopyCounts counts() { return {}; }
+};
+
+template<typename T>
+class CopyBudget {
+public:
+    CopyBudget(std::size_t, const char*) { }
+    CopyBudget(const CopyBudget&) = delete;
+    CopyBudget& operator=(const CopyBudget&) = delete;
+
+    std::size_t copies() const { return 0; }
+};
+
+#endif
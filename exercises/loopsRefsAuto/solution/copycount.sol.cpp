@@ -0,0 +1,52 @@
+#include "CopyCounter.hpp"
+#include <iostream>
+#include <vector>
+
+/*
+ * The loops of loopsRefsAuto.cpp, with counters instead of printouts.
+ * Build without NDEBUG to see the numbers. In a release build, CopyCounted compiles
+ * to nothing, and all counts are zero.
+ */
+
+struct DontCopyMe : CopyCounted<DontCopyMe> {
+   int resultA = 0;
+   int resultB = 0;
+};
+
+int main() {
+   std::vector<DontCopyMe> collection(10);
+   for (std::size_t i = 0; i < collection.size(); ++i) {
+      collection[i].resultA = i;
+      collection[i].resultB = 2*i;
+   }
+
+   // The accidental copy
+   auto before = DontCopyMe::counts();
+   int resultA = 0;
+   for (auto item : collection) {
+      resultA += item.resultA;
+   }
+   const auto byValue = DontCopyMe::counts();
+   std::cout << "auto item:         " << byValue.copies() - before.copies() << " copies\n";
+
+   // The hot loop must not copy at all. If it did, the budget would abort the program.
+   int resultB = 0;
+   {
+      CopyBudget<DontCopyMe> budget{0, "analysis loop"};
+      for (auto const & item : collection) {
+         resultB += item.resultB;
+      }
+      std::cout << "auto const & item: " << budget.copies() << " copies\n";
+   }
+   std::cout << "resultA = " << resultA << "\tresultB = " << resultB << "\n";
+
+   // Growing a vector moves the elements, because the generated move constructor is noexcept
+   before = DontCopyMe::counts();
+   collection.push_back(DontCopyMe{});
+   const auto grown = DontCopyMe::counts();
+   std::cout << "push_back:         " << grown.moves() - before.moves() << " moves, "
+             << grown.copies() - before.copies() << " copies\n";
+
+   std::cout << "In total: " << DontCopyMe::counts() << '\n';
+   return 0;
+}
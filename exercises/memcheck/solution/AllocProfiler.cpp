@@ -0,0 +1,285 @@
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+#include <execinfo.h>
+
+/*
+ * An allocation profiler. It replaces the global operator new and delete, and counts for
+ * every call stack how many allocations were made, how many bytes they had, and how many
+ * bytes were alive at most at the same time. At exit, it prints the totals and the call
+ * stacks with the most bytes to stderr.
+ *
+ * It doesn't need to be compiled into a program. Preload it into any executable:
+ *   LD_PRELOAD=./liballocprofiler.so ./memleak
+ * Link the executable with -rdynamic to see function names instead of addresses.
+ *
+ * Environment variables:
+ *   ALLOC_PROFILER_SAMPLE=N   record the call stack of only every N-th allocation of each
+ *                             thread. Per call stack numbers are scaled by N. The totals
+ *                             are always exact. Default: 1 (every allocation).
+ *   ALLOC_PROFILER_TOP=N      number of call stacks in the report. Default: 10.
+ *
+ * Only allocations with new are seen, not those with malloc.
+ */
+
+namespace {
+
+constexpr int stackDepth = 8;
+constexpr int maxProfilerFrames = 6;    // frames of the profiler itself, at most
+constexpr std::size_t maxSites = 4096;  // further call stacks only count in the totals
+constexpr std::uint32_t noSite = ~std::uint32_t{0};
+
+// Stored in front of every block, so delete knows its size and call stack
+struct alignas(alignof(std::max_align_t)) Header {
+    std::size_t size;
+    std::uint32_t site;
+    std::uint32_t offset;   // from the start of the malloc'd block to the header
+};
+
+struct Site {
+    void* stack[stackDepth];
+    int depth;
+    std::size_t count;
+    std::size_t bytes;
+    std::size_t live;
+    std::size_t peak;
+};
+
+struct Totals {
+    std::atomic<std::size_t> allocations{0};
+    std::atomic<std::size_t> deallocations{0};
+    std::atomic<std::size_t> bytes{0};
+    std::atomic<std::size_t> live{0};
+    std::atomic<std::size_t> peak{0};
+};
+
+// Plain static storage, so it's usable before any constructor runs
+Site sites[maxSites];
+std::size_t nSites = 0;
+std::mutex sitesMutex;
+Totals totals;
+
+// Set while the profiler itself runs, so its own allocations aren't recorded
+thread_local bool insideProfiler = false;
+thread_local std::size_t untilNextSample = 0;
+
+std::size_t hashStack(void* const* stack, int depth) {
+    std::size_t hash = 14695981039346656037ull;
+    for (int i = 0; i < depth; ++i) {
+        hash = (hash ^ reinterpret_cast<std::uintptr_t>(stack[i])) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// Find or create the site for a call stack. Requires sitesMutex.
+std::uint32_t findSite(void* const* stack, int depth) {
+    std::size_t i = hashStack(stack, depth) % maxSites;
+    for (std::size_t probe = 0; probe < maxSites; ++probe, i = (i + 1) % maxSites) {
+        Site& site = sites[i];
+        if (site.depth == 0) {
+            if (nSites == maxSites / 2) break;   // keep the table fast to search
+            std::copy(stack, stack + depth, site.stack);
+            site.depth = depth;
+            ++nSites;
+            return static_cast<std::uint32_t>(i);
+        }
+        if (site.depth == depth && std::equal(stack, stack + depth, site.stack)) {
+            return static_cast<std::uint32_t>(i);
+        }
+    }
+    return noSite;
+}
+
+std::size_t readEnvironment(const char* name, std::size_t fallback) {
+    const char* value = std::getenv(name);
+    const long number = value ? std::atol(value) : 0;
+    return number > 0 ? static_cast<std::size_t>(number) : fallback;
+}
+
+// Read on the first allocation, which can happen before any constructor of the profiler
+std::size_t sampleInterval() {
+    static const std::size_t interval = readEnvironment("ALLOC_PROFILER_SAMPLE", 1);
+    return interval;
+}
+
+void updatePeak(std::atomic<std::size_t>& peak, std::size_t live) {
+    std::size_t current = peak.load(std::memory_order_relaxed);
+    while (current < live && !peak.compare_exchange_weak(current, live, std::memory_order_relaxed)) { }
+}
+
+// caller is the return address of operator new. The stack is recorded from there on,
+// so it doesn't depend on how the profiler's own functions were inlined.
+std::uint32_t recordSample(std::size_t size, void* caller) {
+    insideProfiler = true;
+    void* frames[stackDepth + maxProfilerFrames];
+    const int n = backtrace(frames, stackDepth + maxProfilerFrames);
+    const int first = std::find(frames, frames + std::min(n, maxProfilerFrames + 1), caller) - frames;
+    const int start = first <= maxProfilerFrames ? first : 0;
+    const int depth = std::min(n - start, stackDepth);
+    std::uint32_t index;
+    {
+        std::scoped_lock lock{sitesMutex};
+        index = findSite(frames + start, depth);
+        if (index != noSite) {
+            Site& site = sites[index];
+            site.count += sampleInterval();
+            site.bytes += size * sampleInterval();
+            site.live += size * sampleInterval();
+            site.peak = std::max(site.peak, site.live);
+        }
+    }
+    insideProfiler = false;
+    return index;
+}
+
+void* allocate(std::size_t size, std::size_t alignment, void* caller) {
+    alignment = std::max(alignment, sizeof(Header));
+    // Too large: fail like malloc would, instead of wrapping around below
+    if (size > SIZE_MAX - 2 * alignment) return nullptr;
+    // Leave room for the header in front of the aligned block
+    char* block = static_cast<char*>(std::malloc(size + 2 * alignment));
+    if (!block) return nullptr;
+    char* object = reinterpret_cast<char*>(
+        (reinterpret_cast<std::uintptr_t>(block) + sizeof(Header) + alignment - 1) & ~(alignment - 1));
+    Header* header = reinterpret_cast<Header*>(object) - 1;
+    header->size = size;
+    header->offset = static_cast<std::uint32_t>(reinterpret_cast<char*>(header) - block);
+    header->site = noSite;
+
+    totals.allocations.fetch_add(1, std::memory_order_relaxed);
+    totals.bytes.fetch_add(size, std::memory_order_relaxed);
+    updatePeak(totals.peak, totals.live.fetch_add(size, std::memory_order_relaxed) + size);
+
+    if (!insideProfiler) {
+        if (untilNextSample == 0) {
+            untilNextSample = sampleInterval();
+            header->site = recordSample(size, caller);
+        }
+        --untilNextSample;
+    }
+    return object;
+}
+
+void deallocate(void* object) {
+    if (!object) return;
+    Header* header = static_cast<Header*>(object) - 1;
+    totals.deallocations.fetch_add(1, std::memory_order_relaxed);
+    totals.live.fetch_sub(header->size, std::memory_order_relaxed);
+    if (header->site != noSite) {
+        std::scoped_lock lock{sitesMutex};
+        sites[header->site].live -= header->size * sampleInterval();
+    }
+    std::free(reinterpret_cast<char*>(header) - header->offset);
+}
+
+void* allocateOrThrow(std::size_t size, std::size_t alignment, void* caller) {
+    while (true) {
+        if (void* object = allocate(size, alignment, caller)) return object;
+        // Like the standard operator new: call the new handler, or throw
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc{};
+        handler();
+    }
+}
+
+// Like the standard nothrow operator new: call the new handler, but return nullptr
+// instead of throwing
+void* allocateOrNull(std::size_t size, std::size_t alignment, void* caller) noexcept {
+    try {
+        return allocateOrThrow(size, alignment, caller);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+// Set up when the library is loaded, and print the report when the program ends
+struct Profiler {
+    Profiler() {
+        // The first backtrace() loads libgcc, which allocates. Get that out of the way.
+        insideProfiler = true;
+        void* frames[1];
+        backtrace(frames, 1);
+        insideProfiler = false;
+    }
+
+    ~Profiler() {
+        insideProfiler = true;
+        std::fprintf(stderr, "\n==== Allocation profile ====\n"
+                     "%zu allocations, %zu deallocations, %zu bytes allocated\n"
+                     "peak %zu bytes alive, %zu bytes still alive at exit\n",
+                     totals.allocations.load(), totals.deallocations.load(), totals.bytes.load(),
+                     totals.peak.load(), totals.live.load());
+        if (sampleInterval() > 1) {
+            std::fprintf(stderr, "Call stacks sampled every %zu allocations\n", sampleInterval());
+        }
+
+        std::scoped_lock lock{sitesMutex};
+        Site* sorted[maxSites];
+        std::size_t n = 0;
+        for (auto& site : sites) {
+            if (site.depth != 0) sorted[n++] = &site;
+        }
+        std::sort(sorted, sorted + n, [](const Site* a, const Site* b){ return a->bytes > b->bytes; });
+        const std::size_t top = std::min(n, readEnvironment("ALLOC_PROFILER_TOP", 10));
+        for (std::size_t i = 0; i < top; ++i) {
+            const Site& site = *sorted[i];
+            std::fprintf(stderr, "\n#%zu: %zu allocations, %zu bytes, peak %zu bytes alive, %zu bytes alive at exit\n",
+                         i + 1, site.count, site.bytes, site.peak, site.live);
+            // backtrace_symbols uses malloc, which isn't profiled
+            char** symbols = backtrace_symbols(site.stack, site.depth);
+            for (int frame = 0; frame < site.depth; ++frame) {
+                std::fprintf(stderr, "    %s\n", symbols ? symbols[frame] : "?");
+            }
+            std::free(symbols);
+        }
+        std::fprintf(stderr, "============================\n");
+    }
+};
+
+// Constructed before, and destroyed after, the objects of the program it is preloaded
+// into, so the report also sees their destruction
+__attribute__((init_priority(101))) Profiler profiler;
+
+} // namespace
+
+#define CALLER __builtin_return_address(0)
+
+void* operator new(std::size_t size) { return allocateOrThrow(size, alignof(std::max_align_t), CALLER); }
+void* operator new[](std::size_t size) { return allocateOrThrow(size, alignof(std::max_align_t), CALLER); }
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return allocateOrThrow(size, static_cast<std::size_t>(alignment), CALLER);
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return allocateOrThrow(size, static_cast<std::size_t>(alignment), CALLER);
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocateOrNull(size, alignof(std::max_align_t), CALLER);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return allocateOrNull(size, alignof(std::max_align_t), CALLER);
+}
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocateOrNull(size, static_cast<std::size_t>(alignment), CALLER);
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocateOrNull(size, static_cast<std::size_t>(alignment), CALLER);
+}
+
+void operator delete(void* object) noexcept { deallocate(object); }
+void operator delete[](void* object) noexcept { deallocate(object); }
+void operator delete(void* object, std::size_t) noexcept { deallocate(object); }
+void operator delete[](void* object, std::size_t) noexcept { deallocate(object); }
+void operator delete(void* object, std::align_val_t) noexcept { deallocate(object); }
+void operator delete[](void* object, std::align_val_t) noexcept { deallocate(object); }
+void operator delete(void* object, std::size_t, std::align_val_t) noexcept { deallocate(object); }
+void operator delete[](void* object, std::size_t, std::align_val_t) noexcept { deallocate(object); }
+void operator delete(void* object, const std::nothrow_t&) noexcept { deallocate(object); }
+void operator delete[](void* object, const std::nothrow_t&) noexcept { deallocate(object); }
+void operator delete(void* object, std::align_val_t, const std::nothrow_t&) noexcept { deallocate(object); }
+void operator delete[](void* object, std::align_val_t, const std::nothrow_t&) noexcept { deallocate(object); }
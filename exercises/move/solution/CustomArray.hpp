@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * CustomArray from trymove.sol.cpp, with an allocator parameter.
+ *
+ * Moving and swapping only exchange pointers and allocators, and they are noexcept, so
+ * std::vector moves the arrays when it grows instead of copying them.
+ *
+ * With a PoolAllocator, all arrays of a batch come from one BlockPool, a single
+ * contiguous allocation. Creating, moving and destroying arrays then never calls
+ * operator new, and arrays that are used together are close in memory.
+ *
+ *   BlockPool<int> pool(CustomArray<>::size, 10000);
+ *   std::vector<CustomArray<PoolAllocator<int>>> arrays;
+ *   for (...) arrays.emplace_back(PoolAllocator<int>{pool});
+ */
+
+// Fixed-size blocks from one contiguous allocation. Freed blocks are reused.
+template<typename T>
+class BlockPool {
+public:
+    BlockPool(std::size_t blockSize, std::size_t nBlocks)
+      : m_blockSize(blockSize), m_nBlocks(nBlocks),
+        m_storage(std::allocator<T>{}.allocate(blockSize * nBlocks)) {
+        m_free.reserve(nBlocks);
+        for (std::size_t i = nBlocks; i-- > 0;) {
+            m_free.push_back(m_storage + i * blockSize);
+        }
+    }
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    ~BlockPool() {
+        std::allocator<T>{}.deallocate(m_storage, m_blockSize * m_nBlocks);
+    }
+
+    std::size_t blockSize() const { return m_blockSize; }
+
+    // Returns nullptr if the pool is exhausted
+    T* allocate() {
+        if (m_free.empty()) return nullptr;
+        T* block = m_free.back();
+        m_free.pop_back();
+        return block;
+    }
+
+    void deallocate(T* block) { m_free.push_back(block); }
+
+    bool owns(const T* p) const {
+        return std::less_equal<>{}(m_storage, p) && std::less<>{}(p, m_storage + m_blockSize * m_nBlocks);
+    }
+
+private:
+    std::size_t m_blockSize;
+    std::size_t m_nBlocks;
+    T* m_storage;
+    std::vector<T*> m_free;
+};
+
+// Hands out the blocks of a BlockPool. Requests of any other size, or those that don't fit
+// into the pool any more, go to operator new.
+template<typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+    // The allocator moves along with the memory, so moves never need to copy
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    explicit PoolAllocator(BlockPool<T>& pool) noexcept : m_pool(&pool) { }
+
+    T* allocate(std::size_t n) {
+        if (n == m_pool->blockSize()) {
+            if (T* block = m_pool->allocate()) return block;
+        }
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        if (m_pool->owns(p)) {
+            m_pool->deallocate(p);
+        } else {
+            std::allocator<T>{}.deallocate(p, n);
+        }
+    }
+
+    friend bool operator==(const PoolAllocator& a, const PoolAllocator& b) { return a.m_pool == b.m_pool; }
+    friend bool operator!=(const PoolAllocator& a, const PoolAllocator& b) { return a.m_pool != b.m_pool; }
+
+private:
+    BlockPool<T>* m_pool;
+};
+
+template<typename Allocator = std::allocator<int>>
+class CustomArray {
+    using Traits = std::allocator_traits<Allocator>;
+    static_assert(Traits::propagate_on_container_move_assignment::value || Traits::is_always_equal::value,
+                  "Moving must not need to copy the elements");
+
+public:
+    static constexpr std::size_t size = 10000;
+
+    explicit CustomArray(const Allocator& allocator = Allocator{})
+      : m_allocator(allocator), m_storage(Traits::allocate(m_allocator, size)) {
+        std::fill(m_storage, m_storage + size, 0);
+    }
+
+    // A copy of a moved-from array has no storage either
+    CustomArray(const CustomArray& other)
+      : m_allocator(Traits::select_on_container_copy_construction(other.m_allocator)),
+        m_storage(other.m_storage ? Traits::allocate(m_allocator, size) : nullptr) {
+        if (m_storage) std::copy(other.m_storage, other.m_storage + size, m_storage);
+    }
+
+    CustomArray& operator=(const CustomArray& other) {
+        if (this == &other) return *this;
+        if (!other.m_storage) {
+            release();
+        } else {
+            // Both arrays have the same size, so we can reuse our memory, if we still have it
+            if (!m_storage) m_storage = Traits::allocate(m_allocator, size);
+            std::copy(other.m_storage, other.m_storage + size, m_storage);
+        }
+        return *this;
+    }
+
+    // A moved-from array has no storage. It can only be destroyed, copied or assigned to.
+    CustomArray(CustomArray&& other) noexcept
+      : m_allocator(other.m_allocator), m_storage(std::exchange(other.m_storage, nullptr)) { }
+
+    CustomArray& operator=(CustomArray&& other) noexcept {
+        swap(*this, other);
+        return *this;
+    }
+
+    ~CustomArray() {
+        release();
+    }
+
+    friend void swap(CustomArray& a, CustomArray& b) noexcept {
+        using std::swap;
+        swap(a.m_allocator, b.m_allocator);
+        swap(a.m_storage, b.m_storage);
+    }
+
+    int& operator[](std::size_t index) { return m_storage[index]; }
+    const int& operator[](std::size_t index) const { return m_storage[index]; }
+
+private:
+    void release() noexcept {
+        if (m_storage) Traits::deallocate(m_allocator, std::exchange(m_storage, nullptr), size);
+    }
+
+    Allocator m_allocator;
+    int* m_storage;
+};
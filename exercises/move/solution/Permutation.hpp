@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/*
+ * Shuffle heavy objects without moving them around 10*len times.
+ *
+ * - randomPermutation(n, engine) shuffles the indices 0 .. n-1 instead of the objects.
+ * - applyPermutation(v, permutation) reorders v once, so that afterwards
+ *   v[i] == old v[permutation[i]]. It follows the cycles of the permutation: a cycle of
+ *   length L costs L + 1 moves, because its first element goes through a temporary, and
+ *   elements that stay in place aren't moved. So it's n + (number of cycles) moves, not n,
+ *   and at most 3n/2 when all cycles have length 2.
+ * - PermutedView(v, permutation) doesn't move anything: view[i] is v[permutation[i]].
+ */
+
+template<typename URBG>
+std::vector<std::size_t> randomPermutation(std::size_t n, URBG&& engine) {
+    std::vector<std::size_t> permutation(n);
+    std::iota(permutation.begin(), permutation.end(), std::size_t{0});
+    std::shuffle(permutation.begin(), permutation.end(), engine);
+    return permutation;
+}
+
+// The permutation is taken by value, because we mark the visited positions in it.
+// It is checked before anything is moved, so v is unchanged if it throws.
+template<typename T>
+void applyPermutation(std::vector<T>& v, std::vector<std::size_t> permutation) {
+    if (permutation.size() != v.size()) {
+        throw std::invalid_argument("Permutation and vector have different sizes");
+    }
+    std::vector<bool> seen(v.size());
+    for (std::size_t index : permutation) {
+        if (index >= v.size() || seen[index]) {
+            throw std::invalid_argument("Not a permutation");
+        }
+        seen[index] = true;
+    }
+    for (std::size_t start = 0; start < v.size(); ++start) {
+        if (permutation[start] == start) continue;
+        // Walk along the cycle that contains start: each position takes the element from
+        // the position the permutation points to, and the last one takes the first element.
+        T first = std::move(v[start]);
+        std::size_t current = start;
+        while (true) {
+            const std::size_t next = permutation[current];
+            permutation[current] = current;
+            if (next == start) {
+                v[current] = std::move(first);
+                break;
+            }
+            v[current] = std::move(v[next]);
+            current = next;
+        }
+    }
+}
+
+// A reordered view of a container. The container and the permutation must outlive it.
+template<typename Container>
+class PermutedView {
+public:
+    using value_type = typename Container::value_type;
+    using reference = decltype(std::declval<Container&>()[0]);
+
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = PermutedView::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::remove_reference_t<PermutedView::reference>*;
+        using reference = PermutedView::reference;
+
+        Iterator() = default;
+        Iterator(Container* container, const std::size_t* index) : m_container(container), m_index(index) { }
+
+        reference operator*() const { return (*m_container)[*m_index]; }
+        pointer operator->() const { return &**this; }
+        Iterator& operator++() { ++m_index; return *this; }
+        Iterator operator++(int) { Iterator old = *this; ++m_index; return old; }
+        friend bool operator==(const Iterator& a, const Iterator& b) { return a.m_index == b.m_index; }
+        friend bool operator!=(const Iterator& a, const Iterator& b) { return a.m_index != b.m_index; }
+
+    private:
+        Container* m_container = nullptr;
+        const std::size_t* m_index = nullptr;
+    };
+
+    PermutedView(Container& container, const std::vector<std::size_t>& permutation)
+      : m_container(container), m_permutation(permutation) {
+        if (permutation.size() != container.size()) {
+            throw std::invalid_argument("Permutation and container have different sizes");
+        }
+    }
+
+    std::size_t size() const { return m_permutation.size(); }
+
+    reference operator[](std::size_t i) const { return m_container[m_permutation[i]]; }
+
+    Iterator begin() const { return {&m_container, m_permutation.data()}; }
+    Iterator end() const { return {&m_container, m_permutation.data() + m_permutation.size()}; }
+
+private:
+    Container& m_container;
+    const std::vector<std::size_t>& m_permutation;
+};
@@ -0,0 +1,102 @@
+#include "CustomArray.hpp"
+#include "Permutation.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/*
+ * Three ways to bring the CustomArrays of trymove.cpp into a random order:
+ * 1. randomiseOrder() from trymove.sol.cpp: 10*len swaps of the arrays
+ * 2. shuffle indices, and apply the permutation once with applyPermutation()
+ * 3. shuffle indices, and look at the arrays through a PermutedView
+ * To check that the orders agree, we compare the first element of every array.
+ * CountedArray counts how often arrays are moved or swapped.
+ *
+ * Usage: permute.sol [nArrays]
+ */
+
+using Clock = std::chrono::steady_clock;
+
+// A CustomArray that counts its moves and swaps
+struct CountedArray : CustomArray<> {
+    inline static std::size_t moves = 0;
+    inline static std::size_t swaps = 0;
+
+    CountedArray() = default;
+    CountedArray(CountedArray&& other) noexcept : CustomArray(std::move(other)) { ++moves; }
+    CountedArray& operator=(CountedArray&& other) noexcept {
+        CustomArray::operator=(std::move(other));
+        ++moves;
+        return *this;
+    }
+
+    // Like CustomArray's swap, only exchanges the pointers
+    friend void swap(CountedArray& a, CountedArray& b) noexcept {
+        ++swaps;
+        swap(static_cast<CustomArray&>(a), static_cast<CustomArray&>(b));
+    }
+
+    static void reset() { moves = swaps = 0; }
+};
+
+void randomiseOrder(std::vector<CountedArray>& v) {
+    const auto len = v.size();
+    std::default_random_engine e;
+    std::uniform_int_distribution<std::size_t> randomIntDistr{0, len-1};
+    for (std::size_t i = 0; i < 10*len; i++) {
+        swap(v[randomIntDistr(e)], v[randomIntDistr(e)]);
+    }
+}
+
+std::vector<CountedArray> makeArrays(std::size_t n) {
+    std::vector<CountedArray> arrays(n);
+    for (std::size_t i = 0; i < n; ++i) arrays[i][0] = static_cast<int>(i);
+    CountedArray::reset();
+    return arrays;
+}
+
+template<typename Range>
+long checksum(const Range& range) {
+    long sum = 0, position = 0;
+    for (const auto& array : range) sum += ++position * array[0];
+    return sum;
+}
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    const std::size_t nArrays = argc > 1 ? std::atoi(argv[1]) : 10000;
+
+    {
+        auto arrays = makeArrays(nArrays);
+        const auto start = Clock::now();
+        randomiseOrder(arrays);
+        std::cout << "swaps:             " << secondsSince(start) << " s, "
+                  << CountedArray::swaps << " swaps, " << CountedArray::moves << " moves\n";
+    }
+
+    std::default_random_engine engine;
+    const auto permutation = randomPermutation(nArrays, engine);
+    long expected = 0;
+    {
+        auto arrays = makeArrays(nArrays);
+        const auto start = Clock::now();
+        applyPermutation(arrays, permutation);
+        std::cout << "applyPermutation:  " << secondsSince(start) << " s, "
+                  << CountedArray::moves << " moves\n";
+        expected = checksum(arrays);
+    }
+    {
+        auto arrays = makeArrays(nArrays);
+        const auto start = Clock::now();
+        const PermutedView view(arrays, permutation);
+        const long sum = checksum(view);
+        std::cout << "PermutedView:      " << secondsSince(start) << " s, "
+                  << CountedArray::moves << " moves"
+                  << (sum == expected ? "" : ", ERROR: different order!") << '\n';
+    }
+}
@@ -0,0 +1,66 @@
+#include "CustomArray.hpp"
+#include "../../common/AllocationCounter.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/*
+ * Like trymove.sol.cpp, we create many CustomArrays, and shuffle them with random swaps.
+ * We compare arrays that allocate with operator new (std::allocator) with arrays that
+ * come from one BlockPool.
+ *
+ * AllocationCounter.hpp replaces the global operator new to count allocations. Copying
+ * an array would allocate, so no allocation while the vector grows or while shuffling
+ * means no copy.
+ *
+ * Usage: pooledmove.sol [nArrays]
+ */
+
+template<typename Array>
+void randomiseOrder(std::vector<Array>& v) {
+    const auto len = v.size();
+    std::default_random_engine e;
+    std::uniform_int_distribution<std::size_t> randomIntDistr{0, len-1};
+    for (std::size_t i = 0; i < 10*len; i++) {
+        swap(v[randomIntDistr(e)], v[randomIntDistr(e)]);
+    }
+}
+
+template<typename Array, typename MakeArray>
+void run(const char* name, std::size_t nArrays, MakeArray makeArray) {
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    const auto allocationsBefore = allocations();
+
+    // No reserve(): the vector has to grow a few times
+    std::vector<Array> vec;
+    for (std::size_t i = 0; i < nArrays; ++i) {
+        vec.push_back(makeArray());
+    }
+    const auto allocationsFill = allocations() - allocationsBefore;
+    const auto grown = Clock::now();
+
+    randomiseOrder(vec);
+    const auto allocationsShuffle = allocations() - allocationsBefore - allocationsFill;
+    const std::chrono::duration<double> fillTime = grown - start;
+    const std::chrono::duration<double> shuffleTime = Clock::now() - grown;
+
+    std::cout << name << ":\n"
+              << "  fill:    " << fillTime.count() << " s, " << allocationsFill << " allocations\n"
+              << "  shuffle: " << shuffleTime.count() << " s, " << allocationsShuffle << " allocations\n";
+}
+
+int main(int argc, char* argv[]) {
+    const std::size_t nArrays = argc > 1 ? std::atoi(argv[1]) : 10000;
+    static_assert(std::is_nothrow_move_constructible_v<CustomArray<>>);
+
+    run<CustomArray<>>("std::allocator", nArrays, [](){ return CustomArray<>{}; });
+
+    // The pool itself is one allocation for all arrays (and one for its free list)
+    BlockPool<int> pool(CustomArray<>::size, nArrays);
+    run<CustomArray<PoolAllocator<int>>>("BlockPool", nArrays, [&pool](){
+        return CustomArray<PoolAllocator<int>>{PoolAllocator<int>{pool}};
+    });
+}
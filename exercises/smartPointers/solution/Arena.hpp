@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#endif
+
+/*
+ * A monotonic arena for batches of large objects, usable as a std::pmr::memory_resource.
+ *
+ * The arena reserves one large region up front. Allocating only moves a pointer forward,
+ * and deallocating does nothing. When the batch is done, release() makes the whole region
+ * available again in O(1). Since the same memory is used for every batch, the operating
+ * system doesn't have to map fresh pages each time.
+ *
+ * On Linux, the region is backed by huge pages (2 MB instead of 4 kB) if possible: first
+ * we ask for reserved huge pages (MAP_HUGETLB), and if there are none, we ask for
+ * transparent huge pages (madvise). This saves page faults and TLB misses. On other
+ * systems, the region comes from mmap or operator new.
+ *
+ * Objects in the arena can be owned by a std::unique_ptr with PmrDeleter, or be stored in
+ * std::pmr containers:
+ *   HugePageArena arena(100 << 20);
+ *   {
+ *     std::vector<PmrUniquePtr<LargeObject>> batch;
+ *     batch.push_back(makePmrUnique<LargeObject>(arena));
+ *   }               // destructors run here, but no memory is freed
+ *   arena.release();
+ * All objects must be destroyed before release().
+ */
+class HugePageArena : public std::pmr::memory_resource {
+public:
+    static constexpr std::size_t hugePageSize = 2 << 20;
+
+    // The capacity is rounded up to a multiple of the huge page size, and must not be 0
+    explicit HugePageArena(std::size_t capacity) : m_capacity(roundCapacity(capacity)) {
+#if defined(__unix__) || defined(__APPLE__)
+        void* region = MAP_FAILED;
+#ifdef MAP_HUGETLB
+        region = mmap(nullptr, m_capacity, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        m_hugePages = region != MAP_FAILED ? HugePages::Reserved : HugePages::None;
+#endif
+        if (region == MAP_FAILED) {
+            region = mmap(nullptr, m_capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (region == MAP_FAILED) throw std::bad_alloc{};
+#ifdef MADV_HUGEPAGE
+            if (madvise(region, m_capacity, MADV_HUGEPAGE) == 0) m_hugePages = HugePages::Transparent;
+#endif
+        }
+        m_region = static_cast<std::byte*>(region);
+#else
+        m_region = static_cast<std::byte*>(::operator new(m_capacity, std::align_val_t{hugePageSize}));
+#endif
+    }
+
+    HugePageArena(const HugePageArena&) = delete;
+    HugePageArena& operator=(const HugePageArena&) = delete;
+
+    ~HugePageArena() {
+#if defined(__unix__) || defined(__APPLE__)
+        munmap(m_region, m_capacity);
+#else
+        ::operator delete(m_region, std::align_val_t{hugePageSize});
+#endif
+    }
+
+    // Make all memory available again. All objects in the arena must be destroyed.
+    void release() { m_used = 0; }
+
+    std::size_t capacity() const { return m_capacity; }
+    std::size_t used() const { return m_used; }
+
+    enum class HugePages { None, Transparent, Reserved };
+    HugePages hugePages() const { return m_hugePages; }
+
+private:
+    static std::size_t roundCapacity(std::size_t capacity) {
+        if (capacity == 0) throw std::invalid_argument("HugePageArena needs a capacity");
+        if (capacity > SIZE_MAX - hugePageSize) throw std::bad_alloc{};
+        return (capacity + hugePageSize - 1) / hugePageSize * hugePageSize;
+    }
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        // Compare with the space that is left, so huge requests can't overflow
+        const std::size_t padding = (alignment - m_used % alignment) % alignment;
+        if (padding > m_capacity - m_used || bytes > m_capacity - m_used - padding) {
+            throw std::bad_alloc{};
+        }
+        const std::size_t begin = m_used + padding;
+        m_used = begin + bytes;
+        return m_region + begin;
+    }
+
+    void do_deallocate(void*, std::size_t, std::size_t) override { }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::size_t m_capacity;
+    std::size_t m_used = 0;
+    std::byte* m_region = nullptr;
+    HugePages m_hugePages = HugePages::None;
+};
+
+// Destroys an object, and gives its memory back to the memory resource it came from
+template<typename T>
+struct PmrDeleter {
+    std::pmr::memory_resource* resource;
+
+    void operator()(T* object) const {
+        std::pmr::polymorphic_allocator<T>{resource}.delete_object(object);
+    }
+};
+
+template<typename T>
+using PmrUniquePtr = std::unique_ptr<T, PmrDeleter<T>>;
+
+template<typename T, typename... Args>
+PmrUniquePtr<T> makePmrUnique(std::pmr::memory_resource& resource, Args&&... args) {
+    T* object = std::pmr::polymorphic_allocator<T>{&resource}.template new_object<T>(std::forward<Args>(args)...);
+    return PmrUniquePtr<T>{object, PmrDeleter<T>{&resource}};
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/*
+ * A copy-on-write handle: copies share one immutable object, and a handle only clones it
+ * when it is modified while shared.
+ *
+ * Copying a CowPtr copies a shared_ptr, so it's O(1) no matter how large the object is.
+ * Reading goes through operator* / operator->, which only give const access. To modify,
+ * ask for mutable_ref(): if other handles still share the object, this handle first makes
+ * its own copy, so the others never see the change.
+ *
+ *   CowPtr<LargeObject> a = makeCow<LargeObject>();
+ *   CowPtr<LargeObject> b = a;        // no copy of the LargeObject
+ *   b.mutable_ref().fData[0] = 1.;    // now b clones, a is unchanged
+ *
+ * Thread safety is the same as for shared_ptr: different handles to the same object can be
+ * read, copied, destroyed and modified with mutable_ref() in different threads. One handle
+ * must not be modified by several threads at the same time.
+ */
+template<typename T>
+class CowPtr {
+public:
+    CowPtr() = default;
+    explicit CowPtr(std::shared_ptr<T> object) : m_object(std::move(object)) { }
+
+    const T& operator*() const { return *m_object; }
+    const T* operator->() const { return m_object.get(); }
+    const T* get() const { return m_object.get(); }
+    explicit operator bool() const { return m_object != nullptr; }
+
+    // Number of handles that share the object
+    long useCount() const { return m_object.use_count(); }
+
+    // Write access. Clones the object first if it's shared with other handles.
+    // An empty handle (default-constructed or moved-from) gets a default-constructed object,
+    // or throws std::logic_error if T has no default constructor.
+    T& mutable_ref() {
+        if (!m_object) {
+            if constexpr (std::is_default_constructible_v<T>) {
+                m_object = std::make_shared<T>();
+            } else {
+                throw std::logic_error("mutable_ref() on an empty CowPtr");
+            }
+        } else if (m_object.use_count() != 1) {
+            m_object = std::make_shared<T>(std::as_const(*m_object));
+        } else {
+            // We are the last owner. The other owners released the object with a release
+            // decrement of the count, and this fence makes sure that all their reads are
+            // finished before we start writing.
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *m_object;
+    }
+
+    // Do the handles share the same object?
+    friend bool operator==(const CowPtr& a, const CowPtr& b) { return a.m_object == b.m_object; }
+    friend bool operator!=(const CowPtr& a, const CowPtr& b) { return a.m_object != b.m_object; }
+
+private:
+    std::shared_ptr<T> m_object;
+};
+
+template<typename T, typename... Args>
+CowPtr<T> makeCow(Args&&... args) {
+    return CowPtr<T>{std::make_shared<T>(std::forward<Args>(args)...)};
+}
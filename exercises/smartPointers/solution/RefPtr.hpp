@@ -0,0 +1,213 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <utility>
+
+/*
+ * An intrusive reference-counted pointer.
+ *
+ * std::shared_ptr keeps its counts in a separate control block, and updates them with
+ * atomic operations on every copy. Here, the count lives inside the object, which derives
+ * from RefCounted. A policy chooses how to count:
+ * - SingleThreadCount: plain integers. Only use the objects in one thread at a time.
+ * - ThreadSafeCount:   atomic integers, like shared_ptr.
+ *
+ *   struct Node : RefCounted<Node, SingleThreadCount> { ... };
+ *   RefPtr<Node> node = makeRef<Node>(...);
+ *   WeakRef<Node> weak = node;
+ *   if (RefPtr<Node> alive = weak.lock()) { ... }
+ *
+ * Weak references are supported through a small "anchor" that is only allocated when the
+ * first WeakRef to an object is created, so objects without weak references pay nothing.
+ * The anchor outlives the object, and tells the weak references that the object is gone.
+ */
+
+struct SingleThreadCount {
+    using Count = long;
+    struct Mutex {
+        void lock() { }
+        void unlock() { }
+    };
+
+    static void increment(Count& count) { ++count; }
+    // Returns the new count
+    static long decrement(Count& count) { return --count; }
+    static bool incrementIfNonZero(Count& count) {
+        if (count == 0) return false;
+        ++count;
+        return true;
+    }
+    static long load(const Count& count) { return count; }
+};
+
+struct ThreadSafeCount {
+    using Count = std::atomic<long>;
+    using Mutex = std::mutex;
+
+    static void increment(Count& count) { count.fetch_add(1, std::memory_order_relaxed); }
+    // Acquire-release, so that the thread that deletes the object sees all writes to it
+    static long decrement(Count& count) { return count.fetch_sub(1, std::memory_order_acq_rel) - 1; }
+    static bool incrementIfNonZero(Count& count) {
+        long current = count.load(std::memory_order_relaxed);
+        while (current != 0) {
+            if (count.compare_exchange_weak(current, current + 1, std::memory_order_relaxed)) return true;
+        }
+        return false;
+    }
+    static long load(const Count& count) { return count.load(std::memory_order_relaxed); }
+};
+
+template<typename T> class RefPtr;
+template<typename T> class WeakRef;
+
+template<typename Derived, typename Policy = SingleThreadCount>
+class RefCounted {
+public:
+    using CountPolicy = Policy;
+
+    long useCount() const { return Policy::load(m_refs); }
+
+protected:
+    RefCounted() = default;
+    // Copies of the object start without references
+    RefCounted(const RefCounted&) { }
+    RefCounted& operator=(const RefCounted&) { return *this; }
+    ~RefCounted() = default;
+
+private:
+    template<typename T> friend class RefPtr;
+    template<typename T> friend class WeakRef;
+
+    // Shared by the weak references. It keeps one reference for the object while the
+    // object is alive. The mutex makes sure that the object isn't deleted while a weak
+    // reference is locking it.
+    struct Anchor {
+        typename Policy::Count refs{1};
+        typename Policy::Mutex mutex;
+        Derived* object;
+
+        explicit Anchor(Derived* object) : object(object) { }
+
+        void release() {
+            if (Policy::decrement(refs) == 0) delete this;
+        }
+    };
+
+    void addRef() const { Policy::increment(m_refs); }
+
+    void release() const {
+        if (Policy::decrement(m_refs) != 0) return;
+        if (Anchor* anchor = m_anchor.load(std::memory_order_acquire)) {
+            {
+                std::scoped_lock lock{anchor->mutex};
+                anchor->object = nullptr;
+            }
+            anchor->release();
+        }
+        delete static_cast<const Derived*>(this);
+    }
+
+    // Create the anchor for the first weak reference
+    Anchor* anchor() const {
+        Anchor* anchor = m_anchor.load(std::memory_order_acquire);
+        if (anchor) return anchor;
+        auto created = new Anchor{const_cast<Derived*>(static_cast<const Derived*>(this))};
+        if (m_anchor.compare_exchange_strong(anchor, created, std::memory_order_acq_rel)) return created;
+        delete created; // another thread was faster
+        return anchor;
+    }
+
+    mutable typename Policy::Count m_refs{0};
+    mutable std::atomic<Anchor*> m_anchor{nullptr};
+};
+
+template<typename T>
+class RefPtr {
+public:
+    RefPtr() = default;
+    RefPtr(std::nullptr_t) { }
+
+    // Takes a reference to an object created with new (or already owned by other RefPtrs)
+    explicit RefPtr(T* object) : m_object(object) {
+        if (m_object) m_object->addRef();
+    }
+
+    RefPtr(const RefPtr& other) : RefPtr(other.m_object) { }
+    RefPtr(RefPtr&& other) noexcept : m_object(std::exchange(other.m_object, nullptr)) { }
+
+    RefPtr& operator=(RefPtr other) noexcept {
+        std::swap(m_object, other.m_object);
+        return *this;
+    }
+
+    ~RefPtr() {
+        if (m_object) m_object->release();
+    }
+
+    void reset() { RefPtr{}.swap(*this); }
+    void swap(RefPtr& other) noexcept { std::swap(m_object, other.m_object); }
+
+    T* get() const { return m_object; }
+    T& operator*() const { return *m_object; }
+    T* operator->() const { return m_object; }
+    explicit operator bool() const { return m_object != nullptr; }
+
+    friend bool operator==(const RefPtr& a, const RefPtr& b) { return a.m_object == b.m_object; }
+    friend bool operator!=(const RefPtr& a, const RefPtr& b) { return a.m_object != b.m_object; }
+
+private:
+    friend class WeakRef<T>;
+
+    struct Adopt { };
+    RefPtr(T* object, Adopt) : m_object(object) { }
+
+    T* m_object = nullptr;
+};
+
+template<typename T, typename... Args>
+RefPtr<T> makeRef(Args&&... args) {
+    return RefPtr<T>{new T(std::forward<Args>(args)...)};
+}
+
+template<typename T>
+class WeakRef {
+    using Anchor = typename T::Anchor;
+
+public:
+    WeakRef() = default;
+
+    WeakRef(const RefPtr<T>& object)
+      : m_anchor(object ? object->anchor() : nullptr) {
+        if (m_anchor) T::CountPolicy::increment(m_anchor->refs);
+    }
+
+    WeakRef(const WeakRef& other) : m_anchor(other.m_anchor) {
+        if (m_anchor) T::CountPolicy::increment(m_anchor->refs);
+    }
+
+    WeakRef(WeakRef&& other) noexcept : m_anchor(std::exchange(other.m_anchor, nullptr)) { }
+
+    WeakRef& operator=(WeakRef other) noexcept {
+        std::swap(m_anchor, other.m_anchor);
+        return *this;
+    }
+
+    ~WeakRef() {
+        if (m_anchor) m_anchor->release();
+    }
+
+    // A RefPtr to the object, or an empty one if the object was deleted
+    RefPtr<T> lock() const {
+        if (!m_anchor) return {};
+        std::scoped_lock lock{m_anchor->mutex};
+        T* object = m_anchor->object;
+        if (!object || !T::CountPolicy::incrementIfNonZero(object->m_refs)) return {};
+        return RefPtr<T>{object, typename RefPtr<T>::Adopt{}};
+    }
+
+    bool expired() const { return !lock(); }
+
+private:
+    Anchor* m_anchor = nullptr;
+};
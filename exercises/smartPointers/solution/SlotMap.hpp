@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/*
+ * A container that hands out handles instead of pointers, as a replacement for
+ * shared_ptr / weak_ptr when objects have one owner and many observers.
+ *
+ * A handle is an index and a generation. Every slot counts how often its object was
+ * erased. A handle is valid as long as the generation of its slot didn't change, so
+ * observers check whether their object is alive with two plain loads and a comparison,
+ * without touching any reference count.
+ *
+ * The objects are stored contiguously, which is good for loops over all of them. Erasing
+ * moves the last object into the gap, so pointers to objects are only valid until the next
+ * insert or erase. Handles stay valid.
+ *
+ *   SlotMap<LargeObject> objects;
+ *   SlotHandle handle = objects.insert(LargeObject{});
+ *   if (LargeObject* object = objects.get(handle)) { ... }
+ *   objects.erase(handle);   // now objects.get(handle) == nullptr
+ *
+ * Like the standard containers, a SlotMap must not be modified while other threads use it.
+ */
+
+struct SlotHandle {
+    std::uint32_t index = 0;
+    std::uint32_t generation = 0;   // 0 is never used, so a default handle is invalid
+
+    friend bool operator==(SlotHandle a, SlotHandle b) { return a.index == b.index && a.generation == b.generation; }
+    friend bool operator!=(SlotHandle a, SlotHandle b) { return !(a == b); }
+};
+
+template<typename T>
+class SlotMap {
+    static constexpr std::uint32_t noSlot = ~std::uint32_t{0};
+
+    struct Slot {
+        std::uint32_t generation = 1;
+        std::uint32_t position = noSlot;   // of the object if occupied, or next free slot if not
+    };
+
+public:
+    std::size_t size() const { return m_objects.size(); }
+    bool empty() const { return m_objects.empty(); }
+
+    void reserve(std::size_t n) {
+        m_objects.reserve(n);
+        m_slotOfObject.reserve(n);
+        m_slots.reserve(n);
+    }
+
+    template<typename... Args>
+    SlotHandle emplace(Args&&... args) {
+        // Everything that can throw comes first, and is undone if it does
+        m_objects.emplace_back(std::forward<Args>(args)...);
+        try {
+            m_slotOfObject.push_back(noSlot);
+            if (m_freeHead == noSlot) m_slots.emplace_back();
+        } catch (...) {
+            if (m_slotOfObject.size() == m_objects.size()) m_slotOfObject.pop_back();
+            m_objects.pop_back();
+            throw;
+        }
+        // Now claim the slot
+        std::uint32_t index;
+        if (m_freeHead != noSlot) {
+            index = m_freeHead;
+            m_freeHead = m_slots[index].position;
+        } else {
+            index = static_cast<std::uint32_t>(m_slots.size() - 1);
+        }
+        const auto position = static_cast<std::uint32_t>(m_objects.size() - 1);
+        m_slotOfObject[position] = index;
+        m_slots[index].position = position;
+        return {index, m_slots[index].generation};
+    }
+
+    SlotHandle insert(T value) {
+        return emplace(std::move(value));
+    }
+
+    bool contains(SlotHandle handle) const {
+        return handle.index < m_slots.size() && m_slots[handle.index].generation == handle.generation;
+    }
+
+    // The object, or nullptr if it was erased
+    T* get(SlotHandle handle) {
+        return contains(handle) ? &m_objects[m_slots[handle.index].position] : nullptr;
+    }
+
+    const T* get(SlotHandle handle) const {
+        return contains(handle) ? &m_objects[m_slots[handle.index].position] : nullptr;
+    }
+
+    // Returns false if the object was already erased
+    bool erase(SlotHandle handle) {
+        if (!contains(handle)) return false;
+        Slot& slot = m_slots[handle.index];
+        // Move the last object into the gap
+        const std::uint32_t position = slot.position;
+        if (position + 1 != m_objects.size()) {
+            m_objects[position] = std::move(m_objects.back());
+            m_slotOfObject[position] = m_slotOfObject.back();
+            m_slots[m_slotOfObject[position]].position = position;
+        }
+        m_objects.pop_back();
+        m_slotOfObject.pop_back();
+        // Invalidate all handles to this slot, and put it on the free list
+        if (++slot.generation == 0) slot.generation = 1;
+        slot.position = m_freeHead;
+        m_freeHead = handle.index;
+        return true;
+    }
+
+    // Iterate over all objects, in no particular order
+    auto begin() { return m_objects.begin(); }
+    auto end() { return m_objects.end(); }
+    auto begin() const { return m_objects.begin(); }
+    auto end() const { return m_objects.end(); }
+
+private:
+    std::vector<T> m_objects;
+    std::vector<std::uint32_t> m_slotOfObject;
+    std::vector<Slot> m_slots;
+    std::uint32_t m_freeHead = noSlot;
+};
@@ -0,0 +1,90 @@
+#include "Arena.hpp"
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <sys/resource.h>
+
+/*
+ * The pattern of problem2(): a batch of ten LargeObjects is created, used and destroyed.
+ * We repeat that many times, creating the objects
+ * - with std::make_unique, so every object is a separate heap allocation
+ * - in a HugePageArena, which is released after every batch
+ * and print the time and the number of page faults per batch.
+ *
+ * Usage: arenabench.sol [nBatches] [objectsPerBatch]
+ */
+
+struct LargeObject {
+    std::array<double, 100000> fData;
+};
+
+long pageFaults() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_minflt + usage.ru_majflt;
+}
+
+template<typename MakeBatch>
+void measure(const char* name, unsigned int nBatches, MakeBatch makeBatch) {
+    const long faultsBefore = pageFaults();
+    const auto start = std::chrono::steady_clock::now();
+    double sum = 0.;
+    for (unsigned int i = 0; i < nBatches; ++i) {
+        sum += makeBatch();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ":\t" << elapsed.count() / nBatches * 1.e6 << " us and "
+              << static_cast<double>(pageFaults() - faultsBefore) / nBatches << " page faults per batch"
+              << (sum == nBatches * 1. ? "" : " (unexpected sum)") << '\n';
+}
+
+// Set up the objects like changeLargeObject() does, and use them
+template<typename Pointer>
+double useBatch(const std::vector<Pointer>& batch) {
+    for (const auto& object : batch) {
+        object->fData.fill(0.);
+        object->fData[0] = 1.;
+    }
+    return batch.front()->fData[0];
+}
+
+int main(int argc, char* argv[]) {
+    const int batchesArgument = argc > 1 ? std::atoi(argv[1]) : 1000;
+    const int objectsArgument = argc > 2 ? std::atoi(argv[2]) : 10;
+    if (batchesArgument <= 0 || objectsArgument <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [nBatches > 0] [objectsPerBatch > 0]\n";
+        return 1;
+    }
+    const unsigned int nBatches = batchesArgument;
+    const unsigned int objectsPerBatch = objectsArgument;
+
+    measure("make_unique", nBatches, [objectsPerBatch](){
+        std::vector<std::unique_ptr<LargeObject>> batch;
+        for (unsigned int i = 0; i < objectsPerBatch; ++i) {
+            batch.push_back(std::make_unique<LargeObject>());
+        }
+        return useBatch(batch);
+    });
+
+    HugePageArena arena(objectsPerBatch * sizeof(LargeObject));
+    const char* hugePages[] = {"no huge pages", "transparent huge pages", "reserved huge pages"};
+    std::cout << "Arena of " << arena.capacity() / (1 << 20) << " MB with "
+              << hugePages[static_cast<int>(arena.hugePages())] << '\n';
+
+    measure("HugePageArena", nBatches, [&arena, objectsPerBatch](){
+        double result;
+        {
+            std::vector<PmrUniquePtr<LargeObject>> batch;
+            for (unsigned int i = 0; i < objectsPerBatch; ++i) {
+                batch.push_back(makePmrUnique<LargeObject>(arena));
+            }
+            result = useBatch(batch);
+        }
+        arena.release();
+        return result;
+    });
+}
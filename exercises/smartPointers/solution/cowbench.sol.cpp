@@ -0,0 +1,93 @@
+#include "CowPtr.hpp"
+#include "../../common/AllocationCounter.hpp"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/*
+ * The Owner of problem 4 either deep-copies its LargeObject, or shares it with a
+ * copy-on-write handle. We create a few LargeObjects, and 1000 Owners (or the number given
+ * as first argument) that are copies of them. Then, some Owners modify their data.
+ *
+ * To measure the memory, AllocationCounter.hpp replaces the global operator new and
+ * delete, and counts the bytes that are currently allocated.
+ *
+ * Usage: cowbench.sol [nOwners] [nPayloads] [nModified]
+ */
+
+struct LargeObject {
+    std::array<double, 100000> fData{};
+};
+
+// Deep copies: every Owner has its own LargeObject
+class DeepOwner {
+public:
+    DeepOwner() : _largeObj(std::make_unique<LargeObject>()) { }
+    DeepOwner(const DeepOwner& other) : _largeObj(std::make_unique<LargeObject>(*other._largeObj)) { }
+
+    const LargeObject& data() const { return *_largeObj; }
+    LargeObject& mutableData() { return *_largeObj; }
+
+private:
+    std::unique_ptr<LargeObject> _largeObj;
+};
+
+// Copy on write: Owners share their LargeObject until they modify it
+class CowOwner {
+public:
+    CowOwner() : _largeObj(makeCow<LargeObject>()) { }
+
+    const LargeObject& data() const { return *_largeObj; }
+    LargeObject& mutableData() { return _largeObj.mutable_ref(); }
+
+private:
+    CowPtr<LargeObject> _largeObj;
+};
+
+template<typename Owner>
+void measure(const char* name, unsigned int nOwners, unsigned int nPayloads, unsigned int nModified) {
+    using Clock = std::chrono::steady_clock;
+    const std::size_t before = allocatedBytes();
+    {
+        std::vector<Owner> originals(nPayloads);
+        std::vector<Owner> owners;
+        owners.reserve(nOwners);
+
+        const auto start = Clock::now();
+        for (unsigned int i = 0; i < nOwners; ++i) {
+            owners.push_back(originals[i % nPayloads]);
+        }
+        const std::chrono::duration<double> copyTime = Clock::now() - start;
+        const std::size_t shared = allocatedBytes() - before;
+
+        // Modify a few Owners in parallel threads, and check that nobody else sees it
+        std::vector<std::thread> threads;
+        for (unsigned int i = 0; i < nModified; ++i) {
+            threads.emplace_back([&owners, i](){ owners[i].mutableData().fData[0] = 1.; });
+        }
+        for (auto& thread : threads) thread.join();
+        const std::size_t modified = allocatedBytes() - before;
+
+        unsigned int nChanged = 0;
+        for (const auto& owner : owners) nChanged += owner.data().fData[0] == 1.;
+
+        std::cout << name << ":\n"
+                  << "  " << nOwners << " copies: " << copyTime.count() << " s, " << shared / (1 << 20) << " MB\n"
+                  << "  after modifying " << nModified << ": " << modified / (1 << 20) << " MB, "
+                  << nChanged << " owners see a change\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const unsigned int nOwners = argc > 1 ? std::atoi(argv[1]) : 1000;
+    const unsigned int nPayloads = argc > 2 ? std::atoi(argv[2]) : 5;
+    const unsigned int nModified = argc > 3 ? std::atoi(argv[3]) : 10;
+    std::cout << "sizeof(LargeObject) = " << sizeof(LargeObject) / 1024 << " kB\n";
+    measure<DeepOwner>("Deep copies", nOwners, nPayloads, nModified);
+    measure<CowOwner>("Copy on write", nOwners, nPayloads, nModified);
+}
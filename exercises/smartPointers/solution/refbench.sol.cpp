@@ -0,0 +1,87 @@
+#include "RefPtr.hpp"
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/*
+ * The pattern of problem3(): a vector of pointers to LargeObjects is copied, elements are
+ * erased from both vectors, and every element is handed to processElement() by value.
+ * We repeat that many times with std::shared_ptr, and with RefPtr with atomic and
+ * non-atomic counts.
+ *
+ * libstdc++ skips the atomic operations of shared_ptr in programs that never start a thread.
+ * Most real programs do, so we start one thread at the beginning.
+ *
+ * Usage: refbench.sol [nRepetitions] [nObjects]
+ */
+
+template<typename Policy>
+struct CountedLargeObject : RefCounted<CountedLargeObject<Policy>, Policy> {
+    std::array<double, 100000> fData{};
+};
+
+using SharedLargeObject = std::shared_ptr<CountedLargeObject<SingleThreadCount>>;
+using RefLargeObject = RefPtr<CountedLargeObject<SingleThreadCount>>;
+using AtomicRefLargeObject = RefPtr<CountedLargeObject<ThreadSafeCount>>;
+
+SharedLargeObject create(SharedLargeObject*) { return std::make_shared<CountedLargeObject<SingleThreadCount>>(); }
+RefLargeObject create(RefLargeObject*) { return makeRef<CountedLargeObject<SingleThreadCount>>(); }
+AtomicRefLargeObject create(AtomicRefLargeObject*) { return makeRef<CountedLargeObject<ThreadSafeCount>>(); }
+
+// Takes the pointer by value on purpose, so every call copies it
+template<typename Pointer>
+double processElement(Pointer element) {
+    return element->fData[0];
+}
+
+template<typename Pointer>
+void measure(const char* name, unsigned int nRepetitions, unsigned int nObjects) {
+    std::vector<Pointer> objVector;
+    for (unsigned int i = 0; i < nObjects; ++i) {
+        objVector.push_back(create(static_cast<Pointer*>(nullptr)));
+    }
+
+    double sum = 0.;
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned int rep = 0; rep < nRepetitions; ++rep) {
+        std::vector<Pointer> objVectorCopy(objVector);
+        std::vector<Pointer> objVectorCopy2(objVector);
+        // removeMiddle() and removeRandom()
+        objVectorCopy.erase(objVectorCopy.begin() + objVectorCopy.size() / 2);
+        objVectorCopy2.erase(objVectorCopy2.begin() + rep % objVectorCopy2.size());
+        for (const auto& element : objVectorCopy) {
+            sum += processElement(element);
+        }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ":\t" << elapsed.count() / nRepetitions * 1.e9 << " ns per repetition"
+              << (sum == 0. ? "" : " (unexpected sum)") << '\n';
+}
+
+// Weak references see when the object is gone
+bool checkWeakReferences() {
+    auto object = makeRef<CountedLargeObject<ThreadSafeCount>>();
+    WeakRef<CountedLargeObject<ThreadSafeCount>> weak = object;
+    const bool aliveBefore = weak.lock() == object;
+    object.reset();
+    return aliveBefore && weak.expired();
+}
+
+int main(int argc, char* argv[]) {
+    const unsigned int nRepetitions = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    const unsigned int nObjects = argc > 2 ? std::atoi(argv[2]) : 10;
+
+    std::thread([](){ }).join();
+
+    if (!checkWeakReferences()) {
+        std::cerr << "Weak references are broken\n";
+        return 1;
+    }
+    measure<SharedLargeObject>("std::shared_ptr", nRepetitions, nObjects);
+    measure<AtomicRefLargeObject>("RefPtr, atomic", nRepetitions, nObjects);
+    measure<RefLargeObject>("RefPtr, non-atomic", nRepetitions, nObjects);
+}
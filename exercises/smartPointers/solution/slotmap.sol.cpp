@@ -0,0 +1,106 @@
+#include "SlotMap.hpp"
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/*
+ * problem4_2() with two kinds of observers: one with a weak_ptr, as in the solution, and
+ * one with a handle into a SlotMap that owns the LargeObjects. We destroy some of the
+ * objects, and then measure how long the observers take to check their object and read
+ * its value.
+ *
+ * A thread is started first, so that shared_ptr uses atomic operations like it does in
+ * multi-threaded programs.
+ *
+ * Usage: slotmap.sol [nRepetitions]
+ */
+
+struct LargeObject {
+    std::array<double, 100000> fData{};
+};
+
+class WeakObserver {
+public:
+    explicit WeakObserver(const std::shared_ptr<LargeObject>& object) : _largeObj(object) { }
+
+    double getValue() const {
+        if (auto data = _largeObj.lock()) {
+            return data->fData[0];
+        }
+        return -1.;
+    }
+
+private:
+    std::weak_ptr<const LargeObject> _largeObj;
+};
+
+class HandleObserver {
+public:
+    HandleObserver(const SlotMap<LargeObject>& objects, SlotHandle handle) : _objects(objects), _handle(handle) { }
+
+    double getValue() const {
+        if (auto data = _objects.get(_handle)) {
+            return data->fData[0];
+        }
+        return -1.;
+    }
+
+private:
+    const SlotMap<LargeObject>& _objects;
+    SlotHandle _handle;
+};
+
+template<typename Observer>
+void measure(const char* name, const std::vector<Observer>& observers, unsigned int nRepetitions) {
+    double sum = 0.;
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned int rep = 0; rep < nRepetitions; ++rep) {
+        for (const auto& observer : observers) {
+            sum += observer.getValue();
+        }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ":\t" << elapsed.count() / (nRepetitions * observers.size()) * 1.e9
+              << " ns per getValue(), sum of values " << sum / nRepetitions << '\n';
+}
+
+int main(int argc, char* argv[]) {
+    const unsigned int nRepetitions = argc > 1 ? std::atoi(argv[1]) : 10000000;
+    std::thread([](){ }).join();
+
+    // Owners with shared_ptr
+    std::vector<std::shared_ptr<LargeObject>> owners;
+    std::vector<WeakObserver> weakObservers;
+    for (unsigned int i = 0; i < 5; ++i) {
+        owners.push_back(std::make_shared<LargeObject>());
+        owners.back()->fData[0] = i;
+        weakObservers.emplace_back(owners.back());
+    }
+    owners.resize(3);
+
+    // One owner for all objects
+    SlotMap<LargeObject> objects;
+    objects.reserve(5);
+    std::vector<SlotHandle> handles;
+    std::vector<HandleObserver> handleObservers;
+    for (unsigned int i = 0; i < 5; ++i) {
+        handles.push_back(objects.emplace());
+        objects.get(handles.back())->fData[0] = i;
+        handleObservers.emplace_back(objects, handles.back());
+    }
+    objects.erase(handles[3]);
+    objects.erase(handles[4]);
+
+    std::cout << "Values of the observers:\n\t";
+    for (const auto& observer : handleObservers) {
+        std::cout << observer.getValue() << " ";
+    }
+    std::cout << "\n";
+
+    measure("weak_ptr", weakObservers, nRepetitions);
+    measure("SlotMap", handleObservers, nRepetitions);
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+/*
+ * A sorted vector that can be read by many threads while a single writer adds elements.
+ *
+ * Readers never lock: they announce the current epoch in their own (cache-line sized)
+ * slot, and then read an immutable version of the data. The writer collects insertions in
+ * a batch, merges them into a new version, and publishes that one with a single atomic
+ * exchange. Old versions are only deleted once no reader can still be looking at them
+ * (epoch based reclamation, similar to RCU).
+ *
+ * Usage:
+ *   ConcurrentOrderedVector<int> v;
+ *   // writer thread
+ *   v.add(3); v.add(1); v.publish();
+ *   // reader threads
+ *   auto reader = v.makeReader();
+ *   auto snapshot = reader.snapshot();
+ *   snapshot.contains(3);
+ */
+template<typename ElementType, typename Compare=std::less<>>
+class ConcurrentOrderedVector {
+    struct Version {
+        std::vector<ElementType> data;
+        std::uint64_t retiredAt = 0;
+    };
+
+    // One slot per reader. 0 means "not reading".
+    struct alignas(64) ReaderSlot {
+        std::atomic<std::uint64_t> epoch{0};
+        std::atomic<bool> inUse{false};
+    };
+
+public:
+    static constexpr std::size_t maxReaders = 64;
+
+    // An immutable view of one published version. Keep it short-lived:
+    // the writer cannot free this version as long as the snapshot exists.
+    // A Reader can only hold one Snapshot at a time.
+    class Snapshot {
+    public:
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+        ~Snapshot() {
+            m_slot.epoch.store(0, std::memory_order_release);
+        }
+
+        std::size_t size() const { return m_version->data.size(); }
+
+        const ElementType& operator[](std::size_t n) const { return m_version->data[n]; }
+
+        const ElementType& at(std::size_t n) const {
+            if (n >= size()) {
+                throw std::out_of_range("too big");
+            }
+            return m_version->data[n];
+        }
+
+        // Index of the first element that is not ordered before value
+        std::size_t lowerBound(const ElementType& value) const {
+            auto it = std::lower_bound(m_version->data.begin(), m_version->data.end(),
+                                       value, m_compare);
+            return it - m_version->data.begin();
+        }
+
+        bool contains(const ElementType& value) const {
+            auto n = lowerBound(value);
+            return n < size() && !m_compare(value, m_version->data[n]);
+        }
+
+    private:
+        friend class ConcurrentOrderedVector;
+        Snapshot(ReaderSlot& slot, const Version* version, const Compare& compare)
+          : m_slot(slot), m_version(version), m_compare(compare) { }
+
+        ReaderSlot& m_slot;
+        const Version* m_version;
+        const Compare& m_compare;
+    };
+
+    // Registration of one reader thread. Each thread should own one Reader.
+    class Reader {
+    public:
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+        ~Reader() {
+            m_slot.inUse.store(false, std::memory_order_release);
+        }
+
+        Snapshot snapshot() const {
+            // Announce the epoch *before* loading the version. If the writer replaces the
+            // version after this point, it will see our announcement and keep the old one.
+            m_slot.epoch.store(m_parent.m_epoch.load());
+            return Snapshot(m_slot, m_parent.m_current.load(), m_parent.m_compare);
+        }
+
+    private:
+        friend class ConcurrentOrderedVector;
+        Reader(const ConcurrentOrderedVector& parent, ReaderSlot& slot)
+          : m_parent(parent), m_slot(slot) { }
+
+        const ConcurrentOrderedVector& m_parent;
+        ReaderSlot& m_slot;
+    };
+
+    // Insertions are published automatically every batchSize elements
+    ConcurrentOrderedVector(std::size_t batchSize = 1024, Compare compare = Compare{})
+      : m_batchSize(batchSize), m_compare(compare), m_current(new Version{}) { }
+
+    ConcurrentOrderedVector(const ConcurrentOrderedVector&) = delete;
+    ConcurrentOrderedVector& operator=(const ConcurrentOrderedVector&) = delete;
+
+    // All readers must be gone when the container is destroyed
+    ~ConcurrentOrderedVector() {
+        delete m_current.load();
+    }
+
+    Reader makeReader() const {
+        for (auto& slot : m_slots) {
+            bool expected = false;
+            if (slot.inUse.compare_exchange_strong(expected, true)) {
+                return Reader(*this, slot);
+            }
+        }
+        throw std::runtime_error("too many readers");
+    }
+
+    // Writer side. Only one thread may call add() and publish().
+    void add(ElementType value);
+    void publish();
+
+    std::size_t pendingSize() const { return m_pending.size(); }
+
+private:
+    void reclaim();
+
+    std::size_t m_batchSize;
+    Compare m_compare;
+    std::atomic<Version*> m_current;
+    std::atomic<std::uint64_t> m_epoch{1};
+    mutable std::array<ReaderSlot, maxReaders> m_slots;
+    std::vector<ElementType> m_pending;
+    std::vector<std::unique_ptr<Version>> m_retired;
+};
+
+template<typename ElementType, typename Compare>
+void ConcurrentOrderedVector<ElementType, Compare>::add(ElementType value) {
+    m_pending.push_back(std::move(value));
+    if (m_pending.size() >= m_batchSize) {
+        publish();
+    }
+}
+
+template<typename ElementType, typename Compare>
+void ConcurrentOrderedVector<ElementType, Compare>::publish() {
+    if (!m_pending.empty()) {
+        // Sort the batch, and merge it with the current version into a new one
+        std::sort(m_pending.begin(), m_pending.end(), m_compare);
+        const Version* current = m_current.load();
+        auto next = std::make_unique<Version>();
+        next->data.reserve(current->data.size() + m_pending.size());
+        std::merge(current->data.begin(), current->data.end(),
+                   std::make_move_iterator(m_pending.begin()), std::make_move_iterator(m_pending.end()),
+                   std::back_inserter(next->data), m_compare);
+        m_pending.clear();
+
+        // Publish, and retire the old version. Readers that announced an epoch from
+        // before the increment might still be reading it.
+        std::unique_ptr<Version> retired{m_current.exchange(next.release())};
+        retired->retiredAt = m_epoch.fetch_add(1) + 1;
+        m_retired.push_back(std::move(retired));
+    }
+    reclaim();
+}
+
+template<typename ElementType, typename Compare>
+void ConcurrentOrderedVector<ElementType, Compare>::reclaim() {
+    // Find the oldest epoch that any reader still announces
+    std::uint64_t oldestEpoch = UINT64_MAX;
+    for (const auto& slot : m_slots) {
+        const auto epoch = slot.epoch.load();
+        if (epoch != 0) oldestEpoch = std::min(oldestEpoch, epoch);
+    }
+    // Versions retired at or before that epoch cannot be seen by anyone any more
+    std::erase_if(m_retired, [oldestEpoch](const auto& version) {
+        return version->retiredAt <= oldestEpoch;
+    });
+}
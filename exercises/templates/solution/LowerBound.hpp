@@ -0,0 +1,58 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+/*
+ * A lower_bound for sorted arrays of arithmetic types ordered with std::less.
+ *
+ * A classic binary search spends most of its time in the last few levels, where each
+ * step is a hard-to-predict branch on data that is already in one cache line.
+ * Here, we do a branchless binary search down to a window of one cache line, and then
+ * count how many keys of the window are smaller than the value. That last loop has a
+ * fixed length and no branches, so the compiler turns it into SIMD comparisons
+ * (e.g. 8 ints per instruction with AVX2, 4 with SSE2).
+ *
+ * The result is identical to std::lower_bound(data, data + size, value).
+ */
+
+// Element types and comparators for which simdLowerBound can be used
+template<typename ElementType, typename Compare>
+concept SimdSearchable = std::is_arithmetic_v<ElementType> &&
+    (std::same_as<Compare, std::less<>> || std::same_as<Compare, std::less<ElementType>>);
+
+template<typename ElementType>
+std::size_t simdLowerBound(const ElementType* data, std::size_t size, ElementType value) {
+    constexpr std::size_t window = 64 / sizeof(ElementType);
+
+    if (size < window) {
+        // Too small for a full window, just count
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            count += data[i] < value;
+        }
+        return count;
+    }
+
+    // Branchless binary search. The answer is always in [base, base + n].
+    std::size_t base = 0;
+    std::size_t n = size;
+    while (n > window) {
+        const std::size_t half = n / 2;
+        base = (data[base + half - 1] < value) ? base + half : base;
+        n -= half;
+    }
+
+    // Search the last window with vector comparisons. We shift the window to the left
+    // if it would read past the end. This is fine, because all elements before base are
+    // smaller than value anyway.
+    const std::size_t start = std::min(base, size - window);
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < window; ++i) {
+        count += data[start + i] < value;
+    }
+    return start + count;
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "OrderedVector.sol.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * Store a sorted OrderedVector in a file, and open it again as a read-only view using mmap.
+ *
+ * Opening the file is O(1): the data are not read, the operating system only maps the
+ * pages, and loads them when they are accessed. Since the mapping is shared and
+ * read-only, all processes that open the same file share the same pages in memory.
+ *
+ * This only works for trivially copyable elements (no pointers inside), and the file can
+ * only be read on a machine with the same endianness and type layout.
+ *
+ * File layout: a MappedFileHeader, then the elements starting at header.dataOffset.
+ */
+
+struct MappedFileHeader {
+    char magic[8];
+    std::uint64_t elementSize;
+    std::uint64_t count;
+    std::uint64_t dataOffset;
+};
+
+inline constexpr char mappedFileMagic[8] = {'O', 'V', 'E', 'C', 'T', 'O', 'R', '1'};
+
+template<typename ElementType, typename Compare>
+void saveOrderedVector(const OrderedVector<ElementType, Compare>& vector, const std::string& fileName) {
+    static_assert(std::is_trivially_copyable_v<ElementType>, "Elements must be trivially copyable");
+
+    MappedFileHeader header{};
+    std::memcpy(header.magic, mappedFileMagic, sizeof(header.magic));
+    header.elementSize = sizeof(ElementType);
+    header.count = vector.size();
+    // Start the data on a cache line, so they are suitably aligned for any element type
+    header.dataOffset = 64;
+
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    const char padding[64] = {};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(padding, header.dataOffset - sizeof(header));
+    file.write(reinterpret_cast<const char*>(vector.begin()), vector.size() * sizeof(ElementType));
+    if (!file) {
+        throw std::runtime_error("Could not write " + fileName);
+    }
+}
+
+template<typename ElementType, typename Compare=std::less<>>
+class MappedOrderedVector {
+    static_assert(std::is_trivially_copyable_v<ElementType>, "Elements must be trivially copyable");
+
+public:
+    explicit MappedOrderedVector(const std::string& fileName);
+
+    MappedOrderedVector(const MappedOrderedVector&) = delete;
+    MappedOrderedVector& operator=(const MappedOrderedVector&) = delete;
+
+    ~MappedOrderedVector() {
+        munmap(m_mapping, m_mappingSize);
+    }
+
+    unsigned int size() const {
+        return m_len;
+    }
+
+    const ElementType& at(unsigned int n) const {
+      if (n >= m_len) {
+        throw std::out_of_range("too big");
+      }
+      return m_data[n];
+    }
+
+    const ElementType& operator[](unsigned int n) const {
+      return at(n);
+    }
+
+    const ElementType* begin() const {
+        return m_data;
+    }
+
+    const ElementType* end() const {
+        return m_data + m_len;
+    }
+
+    // Index of the first element that is not ordered before value
+    unsigned int lowerBound(const ElementType& value) const {
+        if constexpr (SimdSearchable<ElementType, Compare>) {
+            return static_cast<unsigned int>(simdLowerBound(m_data, m_len, value));
+        } else {
+            return static_cast<unsigned int>(std::lower_bound(m_data, m_data + m_len,
+                                                              value, m_compare) - m_data);
+        }
+    }
+
+    bool contains(const ElementType& value) const {
+        const auto n = lowerBound(value);
+        return n < m_len && !m_compare(value, m_data[n]);
+    }
+
+private:
+    void* m_mapping = nullptr;
+    std::size_t m_mappingSize = 0;
+    const ElementType* m_data = nullptr;
+    unsigned int m_len = 0;
+    Compare m_compare;
+};
+
+template<typename ElementType, typename Compare>
+MappedOrderedVector<ElementType, Compare>::MappedOrderedVector(const std::string& fileName) {
+    const int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open " + fileName);
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0 || static_cast<std::size_t>(status.st_size) < sizeof(MappedFileHeader)) {
+        close(fd);
+        throw std::runtime_error(fileName + " is too small");
+    }
+    m_mappingSize = status.st_size;
+    m_mapping = mmap(nullptr, m_mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping stays valid after closing the file
+    close(fd);
+    if (m_mapping == MAP_FAILED) {
+        throw std::runtime_error("Could not map " + fileName);
+    }
+
+    MappedFileHeader header;
+    std::memcpy(&header, m_mapping, sizeof(header));
+    // The file may be corrupt: check the offset and count without overflowing
+    if (std::memcmp(header.magic, mappedFileMagic, sizeof(header.magic)) != 0 ||
+        header.elementSize != sizeof(ElementType) ||
+        header.dataOffset < sizeof(header) || header.dataOffset > m_mappingSize ||
+        header.dataOffset % alignof(ElementType) != 0 ||
+        header.count > (m_mappingSize - header.dataOffset) / sizeof(ElementType) ||
+        header.count > std::numeric_limits<unsigned int>::max()) {
+        munmap(m_mapping, m_mappingSize);
+        throw std::runtime_error(fileName + " doesn't contain a matching OrderedVector");
+    }
+    m_data = reinterpret_cast<const ElementType*>(static_cast<const char*>(m_mapping) + header.dataOffset);
+    m_len = static_cast<unsigned int>(header.count);
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "OrderedVector.sol.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * A flat, sorted map with a std::map-like interface.
+ *
+ * The keys are kept in an OrderedVector, and the values in a parallel std::vector at the
+ * same indices. Lookups therefore only touch the dense array of keys, and there is no
+ * per-element allocation like in the nodes of std::map.
+ * Insertion and erasure are O(n), so this is meant for small or mostly-read tables.
+ *
+ * Unlike std::map, iterators and references are invalidated by insert and erase.
+ */
+template<typename Key, typename Value, typename Compare=std::less<>>
+class OrderedMap {
+    template<bool isConst>
+    class Iterator {
+        using MapPtr = std::conditional_t<isConst, const OrderedMap*, OrderedMap*>;
+        using ValueRef = std::conditional_t<isConst, const Value&, Value&>;
+
+    public:
+        // Like std::vector<bool>, the iterator hands out a proxy instead of a real reference
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = std::pair<Key, Value>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::pair<const Key&, ValueRef>;
+
+        // Allows it->first and it->second
+        struct Pointer {
+            reference ref;
+            reference* operator->() { return &ref; }
+        };
+        using pointer = Pointer;
+
+        Iterator() = default;
+        Iterator(MapPtr map, unsigned int index) : m_map(map), m_index(index) { }
+        operator Iterator<true>() const { return {m_map, m_index}; }
+
+        reference operator*() const { return {m_map->m_keys[m_index], m_map->m_values[m_index]}; }
+        Pointer operator->() const { return {**this}; }
+
+        Iterator& operator++() { ++m_index; return *this; }
+        Iterator& operator--() { --m_index; return *this; }
+        Iterator operator++(int) { auto old = *this; ++m_index; return old; }
+        Iterator operator--(int) { auto old = *this; --m_index; return old; }
+
+        bool operator==(const Iterator& other) const = default;
+
+        unsigned int index() const { return m_index; }
+
+    private:
+        MapPtr m_map = nullptr;
+        unsigned int m_index = 0;
+    };
+
+public:
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    OrderedMap(unsigned int initialCapacity = 8)
+      : m_keys(initialCapacity) {
+        m_values.reserve(initialCapacity);
+    }
+
+    unsigned int size() const { return m_keys.size(); }
+    bool empty() const { return size() == 0; }
+
+    iterator begin() { return {this, 0}; }
+    iterator end() { return {this, size()}; }
+    const_iterator begin() const { return {this, 0}; }
+    const_iterator end() const { return {this, size()}; }
+
+    // Dense views of all keys and values, in key order
+    std::span<const Key> keys() const { return {m_keys.begin(), m_keys.end()}; }
+    std::span<Value> values() { return m_values; }
+    std::span<const Value> values() const { return m_values; }
+
+    iterator lower_bound(const Key& key) { return {this, m_keys.lowerBound(key)}; }
+    const_iterator lower_bound(const Key& key) const { return {this, m_keys.lowerBound(key)}; }
+
+    iterator find(const Key& key) { return {this, findIndex(key)}; }
+    const_iterator find(const Key& key) const { return {this, findIndex(key)}; }
+
+    bool contains(const Key& key) const { return findIndex(key) != size(); }
+    unsigned int count(const Key& key) const { return contains(key) ? 1 : 0; }
+
+    Value& at(const Key& key) { return m_values[checkedIndex(key)]; }
+    const Value& at(const Key& key) const { return m_values[checkedIndex(key)]; }
+
+    Value& operator[](const Key& key) {
+        return insert(key, Value{}).first->second;
+    }
+
+    // Inserts if the key is not present yet. Returns the position of the key, and whether
+    // an insertion took place.
+    std::pair<iterator, bool> insert(const Key& key, Value value);
+
+    std::pair<iterator, bool> insert_or_assign(const Key& key, Value value) {
+        const auto n = findIndex(key);
+        if (n != size()) {
+            m_values[n] = std::move(value);
+            return {iterator{this, n}, false};
+        }
+        return insert(key, std::move(value));
+    }
+
+    // Returns the number of erased elements (0 or 1)
+    unsigned int erase(const Key& key);
+
+private:
+    unsigned int findIndex(const Key& key) const {
+        const auto n = m_keys.lowerBound(key);
+        if (n < size() && !m_keys.compare()(key, m_keys[n])) {
+            return n;
+        }
+        return size();
+    }
+
+    unsigned int checkedIndex(const Key& key) const {
+        const auto n = findIndex(key);
+        if (n == size()) {
+            throw std::out_of_range("key not found");
+        }
+        return n;
+    }
+
+    OrderedVector<Key, Compare> m_keys;
+    std::vector<Value> m_values;
+};
+
+template<typename Key, typename Value, typename Compare>
+auto OrderedMap<Key, Value, Compare>::insert(const Key& key, Value value) -> std::pair<iterator, bool> {
+    const auto n = m_keys.lowerBound(key);
+    if (n < size() && !m_keys.compare()(key, m_keys[n])) {
+        return {iterator{this, n}, false};
+    }
+    if (size() == m_keys.capacity()) {
+        m_keys.reserve(std::max(8u, 2 * m_keys.capacity()));
+    }
+    // Keys and values must stay in step: undo the value if the key can't be inserted
+    m_values.insert(m_values.begin() + n, std::move(value));
+    try {
+        m_keys.insert(n, key);
+    } catch (...) {
+        m_values.erase(m_values.begin() + n);
+        throw;
+    }
+    return {iterator{this, n}, true};
+}
+
+template<typename Key, typename Value, typename Compare>
+unsigned int OrderedMap<Key, Value, Compare>::erase(const Key& key) {
+    const auto n = findIndex(key);
+    if (n == size()) {
+        return 0;
+    }
+    m_keys.erase(n);
+    m_values.erase(m_values.begin() + n);
+    return 1;
+}
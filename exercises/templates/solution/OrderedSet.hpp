@@ -0,0 +1,66 @@
+#pragma once
+
+#include "OrderedVector.sol.hpp"
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+/*
+ * A flat, sorted set with a std::set-like interface, stored contiguously in an OrderedVector.
+ * Iterators are plain pointers to const keys. They are invalidated by insert and erase.
+ */
+template<typename Key, typename Compare=std::less<>>
+class OrderedSet {
+public:
+    using iterator = const Key*;
+    using const_iterator = const Key*;
+
+    OrderedSet(unsigned int initialCapacity = 8)
+      : m_keys(initialCapacity) { }
+
+    unsigned int size() const { return m_keys.size(); }
+    bool empty() const { return size() == 0; }
+
+    iterator begin() const { return m_keys.begin(); }
+    iterator end() const { return m_keys.end(); }
+
+    iterator lower_bound(const Key& key) const { return begin() + m_keys.lowerBound(key); }
+
+    iterator find(const Key& key) const {
+        const auto it = lower_bound(key);
+        if (it != end() && !m_keys.compare()(key, *it)) {
+            return it;
+        }
+        return end();
+    }
+
+    bool contains(const Key& key) const { return find(key) != end(); }
+    unsigned int count(const Key& key) const { return contains(key) ? 1 : 0; }
+
+    // Inserts if the key is not present yet. Returns the position of the key, and whether
+    // an insertion took place.
+    std::pair<iterator, bool> insert(const Key& key) {
+        const auto n = m_keys.lowerBound(key);
+        if (n < size() && !m_keys.compare()(key, m_keys[n])) {
+            return {begin() + n, false};
+        }
+        if (size() == m_keys.capacity()) {
+            m_keys.reserve(std::max(8u, 2 * m_keys.capacity()));
+        }
+        m_keys.add(key);
+        return {begin() + n, true};
+    }
+
+    // Returns the number of erased elements (0 or 1)
+    unsigned int erase(const Key& key) {
+        const auto it = find(key);
+        if (it == end()) {
+            return 0;
+        }
+        m_keys.erase(it - begin());
+        return 1;
+    }
+
+private:
+    OrderedVector<Key, Compare> m_keys;
+};
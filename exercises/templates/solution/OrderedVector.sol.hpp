@@ -1,6 +1,13 @@
+#pragma once
+
+#include <algorithm>
 #include <memory>
 #include <stdexcept>
 #include <functional>
+#include <iterator>
+#include <ranges>
+#include "LowerBound.hpp"
+#include "ParallelSort.hpp"
 
 template<typename ElementType, typename Compare=std::less<>>
 class OrderedVector {
@@ -8,11 +15,66 @@ public:
     OrderedVector(unsigned int maxLen)
       : m_maxLen(maxLen), m_data(std::make_unique<ElementType[]>(m_maxLen)) { }
 
+    // Bulk construction from unsorted input. The elements are sorted in parallel,
+    // which is much faster than adding them one by one.
+    template<std::forward_iterator Iterator>
+    OrderedVector(Iterator first, Iterator last, unsigned int maxLen = 0)
+      : m_len(static_cast<unsigned int>(std::distance(first, last))),
+        m_maxLen(std::max(maxLen, m_len)),
+        m_data(std::make_unique<ElementType[]>(m_maxLen)) {
+        std::copy(first, last, m_data.get());
+        parallelSort(m_data.get(), m_len, m_compare);
+    }
+
+    template<std::ranges::forward_range Range>
+    explicit OrderedVector(const Range& range, unsigned int maxLen = 0)
+      : OrderedVector(std::ranges::begin(range), std::ranges::end(range), maxLen) { }
+
     OrderedVector(const OrderedVector&) = delete;
     OrderedVector& operator=(const OrderedVector&) = delete;
 
     bool add(ElementType value);
 
+    // Index of the first element that is not ordered before value
+    unsigned int lowerBound(const ElementType& value) const {
+        if constexpr (SimdSearchable<ElementType, Compare>) {
+            return static_cast<unsigned int>(simdLowerBound(m_data.get(), m_len, value));
+        } else {
+            return static_cast<unsigned int>(std::lower_bound(m_data.get(), m_data.get() + m_len,
+                                                              value, m_compare) - m_data.get());
+        }
+    }
+
+    unsigned int size() const {
+        return m_len;
+    }
+
+    unsigned int capacity() const {
+        return m_maxLen;
+    }
+
+    // Grow the storage to hold at least maxLen elements
+    void reserve(unsigned int maxLen);
+
+    // Insert value at index n, which must be where it belongs in the order, e.g. its
+    // lowerBound(). There must be space for it.
+    void insert(unsigned int n, ElementType value);
+
+    // Remove the element at index n
+    void erase(unsigned int n);
+
+    const Compare& compare() const {
+        return m_compare;
+    }
+
+    const ElementType* begin() const {
+        return m_data.get();
+    }
+
+    const ElementType* end() const {
+        return m_data.get() + m_len;
+    }
+
     ElementType& at(unsigned int n) {
       if (n >= m_len) {
         throw std::out_of_range("too big");
@@ -20,10 +82,21 @@ public:
       return m_data[n];
     }
 
+    const ElementType& at(unsigned int n) const {
+      if (n >= m_len) {
+        throw std::out_of_range("too big");
+      }
+      return m_data[n];
+    }
+
     ElementType& operator[](unsigned int n) {
       return at(n);
     }
 
+    const ElementType& operator[](unsigned int n) const {
+      return at(n);
+    }
+
 private:
     unsigned int m_len = 0;
     unsigned int m_maxLen;
@@ -37,9 +110,7 @@ bool OrderedVector<ElementType, Compare>::add(ElementType value) {
         return false;
     }
     // find insertion point
-    unsigned int insertIndex = 0;
-    while (insertIndex < m_len && m_compare(m_data[insertIndex], value))
-        insertIndex++;
+    unsigned int insertIndex = lowerBound(value);
     // move end of vector
     unsigned int index = m_len;
     while (index > insertIndex) {
@@ -51,3 +122,33 @@ bool OrderedVector<ElementType, Compare>::add(ElementType value) {
     m_len++;
     return true;
 }
+
+template<typename ElementType, typename Compare>
+void OrderedVector<ElementType, Compare>::reserve(unsigned int maxLen) {
+    if (maxLen <= m_maxLen) {
+        return;
+    }
+    auto data = std::make_unique<ElementType[]>(maxLen);
+    std::move(m_data.get(), m_data.get() + m_len, data.get());
+    m_data = std::move(data);
+    m_maxLen = maxLen;
+}
+
+template<typename ElementType, typename Compare>
+void OrderedVector<ElementType, Compare>::insert(unsigned int n, ElementType value) {
+    if (n > m_len || m_len >= m_maxLen) {
+        throw std::out_of_range("no space at this index");
+    }
+    std::move_backward(m_data.get() + n, m_data.get() + m_len, m_data.get() + m_len + 1);
+    m_data[n] = std::move(value);
+    m_len++;
+}
+
+template<typename ElementType, typename Compare>
+void OrderedVector<ElementType, Compare>::erase(unsigned int n) {
+    if (n >= m_len) {
+        throw std::out_of_range("too big");
+    }
+    std::move(m_data.get() + n + 1, m_data.get() + m_len, m_data.get() + n);
+    m_len--;
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Sorting of large arrays on all cores.
+ *
+ * - Integers and floats ordered with std::less are sorted with a parallel LSD radix sort.
+ *   Each thread builds a histogram of its chunk, and then scatters its chunk to the
+ *   positions computed from all histograms. This is O(n), and doesn't use the comparator.
+ * - Everything else uses a parallel merge sort: each thread std::sort's one chunk, and
+ *   the sorted runs are merged pairwise. Each merge is itself split across threads by
+ *   binary searching matching split points in both runs.
+ *
+ * Small arrays are sorted with std::sort directly, since starting threads costs more
+ * than it gains.
+ */
+
+namespace parallel_sort_detail {
+
+// Below this size, std::sort is used
+constexpr std::size_t minParallelSize = 1 << 16;
+
+// Call f(0), ..., f(nThreads-1) in parallel, and wait for all of them
+template<typename Function>
+void runInParallel(unsigned int nThreads, Function&& f) {
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < nThreads; ++t) {
+        threads.emplace_back(f, t);
+    }
+    f(0);
+    for (auto& thread : threads) thread.join();
+}
+
+// Begin of chunk t when splitting n elements into nChunks chunks
+inline std::size_t chunkBegin(std::size_t n, unsigned int nChunks, unsigned int t) {
+    return n * t / nChunks;
+}
+
+// Map a key to an unsigned integer with the same ordering
+template<typename T>
+auto radixKey(T value) {
+    if constexpr (std::is_floating_point_v<T>) {
+        using U = std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>;
+        constexpr U signBit = U{1} << (8 * sizeof(U) - 1);
+        const auto bits = std::bit_cast<U>(value);
+        // Negative numbers: flip all bits, positive numbers: flip the sign bit
+        return (bits & signBit) ? U(~bits) : U(bits ^ signBit);
+    } else {
+        using U = std::make_unsigned_t<T>;
+        if constexpr (std::is_signed_v<T>) {
+            return U(U(value) ^ (U{1} << (8 * sizeof(U) - 1)));
+        } else {
+            return U(value);
+        }
+    }
+}
+
+template<typename T>
+void radixSort(T* data, std::size_t n, unsigned int nThreads) {
+    constexpr unsigned int nBuckets = 256;
+    constexpr unsigned int nPasses = sizeof(radixKey(T{}));
+    auto buffer = std::make_unique_for_overwrite<T[]>(n);
+    T* in = data;
+    T* out = buffer.get();
+
+    std::vector<std::array<std::size_t, nBuckets>> counts(nThreads);
+    for (unsigned int pass = 0; pass < nPasses; ++pass) {
+        const unsigned int shift = 8 * pass;
+        auto digit = [shift](T value) { return (radixKey(value) >> shift) & 0xff; };
+
+        runInParallel(nThreads, [&](unsigned int t) {
+            auto& count = counts[t];
+            count.fill(0);
+            for (std::size_t i = chunkBegin(n, nThreads, t); i < chunkBegin(n, nThreads, t+1); ++i) {
+                ++count[digit(in[i])];
+            }
+        });
+
+        // If all elements have the same digit, this pass doesn't change anything
+        bool trivialPass = false;
+        for (unsigned int d = 0; d < nBuckets; ++d) {
+            std::size_t total = 0;
+            for (const auto& count : counts) total += count[d];
+            if (total == n) trivialPass = true;
+        }
+        if (trivialPass) continue;
+
+        // Turn the counts into the position where each thread writes each digit
+        std::size_t offset = 0;
+        for (unsigned int d = 0; d < nBuckets; ++d) {
+            for (auto& count : counts) {
+                const std::size_t c = count[d];
+                count[d] = offset;
+                offset += c;
+            }
+        }
+
+        runInParallel(nThreads, [&](unsigned int t) {
+            auto& position = counts[t];
+            for (std::size_t i = chunkBegin(n, nThreads, t); i < chunkBegin(n, nThreads, t+1); ++i) {
+                out[position[digit(in[i])]++] = in[i];
+            }
+        });
+        std::swap(in, out);
+    }
+
+    if (in != data) {
+        runInParallel(nThreads, [&](unsigned int t) {
+            std::copy(in + chunkBegin(n, nThreads, t), in + chunkBegin(n, nThreads, t+1),
+                      data + chunkBegin(n, nThreads, t));
+        });
+    }
+}
+
+// Merge the sorted ranges [a, a+na) and [b, b+nb) into out, using nThreads threads.
+// Elements from a go first if equal, like std::merge.
+template<typename T, typename Compare>
+void parallelMerge(T* a, std::size_t na, T* b, std::size_t nb, T* out,
+                   Compare& compare, unsigned int nThreads) {
+    runInParallel(nThreads, [&](unsigned int t) {
+        // Split a evenly, and find the matching split point in b
+        auto splitB = [&](unsigned int chunk) -> std::size_t {
+            const std::size_t ia = chunkBegin(na, nThreads, chunk);
+            if (ia == na) return nb;
+            return std::lower_bound(b, b + nb, a[ia], compare) - b;
+        };
+        const std::size_t a0 = chunkBegin(na, nThreads, t);
+        const std::size_t a1 = chunkBegin(na, nThreads, t+1);
+        const std::size_t b0 = t == 0 ? 0 : splitB(t);
+        const std::size_t b1 = splitB(t+1);
+        std::merge(std::make_move_iterator(a + a0), std::make_move_iterator(a + a1),
+                   std::make_move_iterator(b + b0), std::make_move_iterator(b + b1),
+                   out + a0 + b0, compare);
+    });
+}
+
+template<typename T, typename Compare>
+void mergeSort(T* data, std::size_t n, Compare& compare, unsigned int nThreads) {
+    // Sort one run per thread
+    runInParallel(nThreads, [&](unsigned int t) {
+        std::sort(data + chunkBegin(n, nThreads, t), data + chunkBegin(n, nThreads, t+1), compare);
+    });
+
+    // Merge pairs of runs until one is left, alternating between data and buffer
+    std::vector<std::size_t> runs;
+    for (unsigned int t = 0; t <= nThreads; ++t) runs.push_back(chunkBegin(n, nThreads, t));
+    auto buffer = std::make_unique<T[]>(n);
+    T* in = data;
+    T* out = buffer.get();
+    while (runs.size() > 2) {
+        const std::size_t nRuns = runs.size() - 1;
+        const std::size_t nPairs = nRuns / 2;
+        const unsigned int threadsPerPair = std::max<std::size_t>(1, nThreads / nPairs);
+        runInParallel(static_cast<unsigned int>(nPairs + nRuns % 2), [&](unsigned int p) {
+            const std::size_t begin = runs[2*p];
+            if (2*p + 1 == nRuns) {
+                // Odd run out, just move it
+                std::move(in + begin, in + runs[2*p+1], out + begin);
+                return;
+            }
+            const std::size_t middle = runs[2*p+1];
+            const std::size_t end = runs[2*p+2];
+            parallelMerge(in + begin, middle - begin, in + middle, end - middle, out + begin,
+                          compare, threadsPerPair);
+        });
+
+        std::vector<std::size_t> mergedRuns;
+        for (std::size_t i = 0; i < runs.size(); i += 2) mergedRuns.push_back(runs[i]);
+        if (mergedRuns.back() != n) mergedRuns.push_back(n);
+        runs = std::move(mergedRuns);
+        std::swap(in, out);
+    }
+
+    if (in != data) {
+        std::move(in, in + n, data);
+    }
+}
+
+} // namespace parallel_sort_detail
+
+// Element types and comparators that can be sorted with the radix sort
+template<typename T, typename Compare>
+concept RadixSortable =
+    ((std::integral<T> && !std::same_as<T, bool>) ||
+     (std::floating_point<T> && (sizeof(T) == 4 || sizeof(T) == 8))) &&
+    (std::same_as<Compare, std::less<>> || std::same_as<Compare, std::less<T>>);
+
+// Sort [data, data+n) according to compare, using up to nThreads threads
+template<typename T, typename Compare=std::less<>>
+void parallelSort(T* data, std::size_t n, Compare compare = Compare{},
+                  unsigned int nThreads = std::thread::hardware_concurrency()) {
+    using namespace parallel_sort_detail;
+    nThreads = std::max(1u, nThreads);
+    if (n < minParallelSize) {
+        std::sort(data, data + n, compare);
+    } else if constexpr (RadixSortable<T, Compare>) {
+        radixSort(data, n, nThreads);
+    } else {
+        mergeSort(data, n, compare, nThreads);
+    }
+}
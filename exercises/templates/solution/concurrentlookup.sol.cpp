@@ -0,0 +1,89 @@
+#include "ConcurrentOrderedVector.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+/*
+ * Many readers look up keys in a ConcurrentOrderedVector while one writer keeps adding
+ * keys in batches. We measure the number of lookups per second as a function of the
+ * number of reader threads. As readers don't share any written cache line, the
+ * throughput should grow linearly with the number of threads (up to the number of cores).
+ */
+
+constexpr unsigned int nInitialKeys = 1000000;
+constexpr auto measurementTime = std::chrono::milliseconds{500};
+
+double measureLookups(ConcurrentOrderedVector<int>& table, unsigned int nReaders) {
+    std::atomic<bool> stop{false};
+    std::atomic<unsigned long> nLookups{0};
+
+    auto readerFunction = [&](unsigned int seed) {
+        auto reader = table.makeReader();
+        std::default_random_engine e{seed};
+        std::uniform_int_distribution<int> d{0, 2 * static_cast<int>(nInitialKeys)};
+        unsigned long count = 0;
+        unsigned long found = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            auto snapshot = reader.snapshot();
+            for (int i = 0; i < 100; ++i) {
+                found += snapshot.contains(d(e));
+            }
+            count += 100;
+        }
+        nLookups += count;
+        if (found > count) std::cerr << "Impossible\n";
+    };
+
+    // The writer adds a few odd keys while the readers are running,
+    // and publishes them in batches of 100
+    auto writerFunction = [&]() {
+        int key = 1;
+        while (!stop.load(std::memory_order_relaxed)) {
+            table.add(key);
+            key += 2;
+            if (table.pendingSize() == 100) table.publish();
+            std::this_thread::sleep_for(std::chrono::microseconds{100});
+        }
+        table.publish();
+    };
+
+    std::vector<std::thread> readers;
+    for (unsigned int i = 0; i < nReaders; ++i) {
+        readers.emplace_back(readerFunction, i);
+    }
+    std::thread writer{writerFunction};
+
+    const auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(measurementTime);
+    stop = true;
+    for (auto& t : readers) t.join();
+    writer.join();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    return nLookups / elapsed.count();
+}
+
+int main() {
+    // Batches are published explicitly, so the initial fill is merged only once
+    ConcurrentOrderedVector<int> table(nInitialKeys);
+    for (unsigned int i = 0; i < nInitialKeys; ++i) {
+        table.add(2 * i);
+    }
+    table.publish();
+
+    // Every reader thread needs one of the table's reader slots
+    const unsigned int maxThreads = std::clamp(std::thread::hardware_concurrency(), 1u,
+                                               static_cast<unsigned int>(ConcurrentOrderedVector<int>::maxReaders));
+    std::cout << "readers  lookups/s\n";
+    for (unsigned int nReaders = 1; nReaders <= maxThreads; nReaders *= 2) {
+        std::cout << nReaders << "\t " << measureLookups(table, nReaders) << '\n';
+    }
+
+    auto reader = table.makeReader();
+    auto snapshot = reader.snapshot();
+    std::cout << "Final size: " << snapshot.size() << '\n';
+}
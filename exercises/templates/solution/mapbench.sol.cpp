@@ -0,0 +1,70 @@
+#include "OrderedMap.hpp"
+#include "OrderedSet.hpp"
+#include "../../common/AllocationCounter.hpp"
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Compare memory usage and lookup speed of OrderedMap, std::map and std::unordered_map.
+ * To measure the memory, AllocationCounter.hpp replaces the global operator new and
+ * delete, and counts the bytes that are currently allocated.
+ */
+
+constexpr unsigned int nQueries = 1 << 20;
+
+template<typename Map>
+void measure(const char* name, unsigned int nElements) {
+    std::default_random_engine e;
+    std::uniform_int_distribution<int> d{0, 4 * static_cast<int>(nElements)};
+
+    const auto before = allocatedBytes();
+    Map map;
+    for (unsigned int i = 0; i < nElements; ++i) {
+        map[d(e)] = i;
+    }
+    const auto bytes = allocatedBytes() - before;
+
+    std::vector<int> queries(nQueries);
+    for (auto& q : queries) q = d(e);
+
+    const auto start = std::chrono::steady_clock::now();
+    double sum = 0.;
+    for (auto q : queries) {
+        auto it = map.find(q);
+        if (it != map.end()) sum += it->second;
+    }
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    if (sum < 0.) std::cerr << "Unexpected\n";
+
+    std::cout << name << "\t" << map.size() << "\t" << bytes << " B\t"
+              << static_cast<double>(bytes) / map.size() << " B/element\t"
+              << elapsed.count() / nQueries << " ns/lookup\n";
+}
+
+int main() {
+    // Quick check of the interface
+    OrderedMap<std::string, int> ages;
+    ages["Bob"] = 42;
+    ages.insert("Alice", 37);
+    ages.insert_or_assign("Carol", 12);
+    ages.erase("Bob");
+    for (const auto& [name, age] : ages) {
+        std::cout << name << ": " << age << '\n';
+    }
+    OrderedSet<int> set;
+    for (int i : {5, 3, 5, 1}) set.insert(i);
+    for (int i : set) std::cout << i << ' ';
+    std::cout << "\n\n";
+
+    for (unsigned int n : {16u, 256u, 4096u, 65536u}) {
+        measure<OrderedMap<int, double>>("OrderedMap", n);
+        measure<std::map<int, double>>("map\t", n);
+        measure<std::unordered_map<int, double>>("unordered_map", n);
+        std::cout << '\n';
+    }
+}
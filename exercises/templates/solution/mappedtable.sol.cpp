@@ -0,0 +1,58 @@
+#include "MappedOrderedVector.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * Build a large sorted table once, store it in a file, and reopen it with mmap.
+ * Opening the mapped table takes microseconds, independent of its size, whereas
+ * building it needs to sort all elements again.
+ * The file name can be given as first argument. Run the program a second time with
+ * "--reuse" as second argument to skip the build, and only open the existing file.
+ */
+
+int main(int argc, char* argv[]) {
+    using Clock = std::chrono::steady_clock;
+    const std::string fileName = argc > 1 ? argv[1] : "mappedtable.bin";
+    const bool reuse = argc > 2 && std::string(argv[2]) == "--reuse";
+    constexpr unsigned int nElements = 10000000;
+
+    std::default_random_engine e;
+    std::uniform_int_distribution<int> d{0, 1 << 30};
+
+    if (!reuse) {
+        std::vector<int> keys(nElements);
+        for (auto& k : keys) k = d(e);
+
+        auto start = Clock::now();
+        OrderedVector<int> table(keys);
+        const std::chrono::duration<double, std::milli> buildTime = Clock::now() - start;
+
+        start = Clock::now();
+        saveOrderedVector(table, fileName);
+        const std::chrono::duration<double, std::milli> saveTime = Clock::now() - start;
+        std::cout << "Building the table took " << buildTime.count() << " ms, saving "
+                  << saveTime.count() << " ms\n";
+    }
+
+    auto start = Clock::now();
+    MappedOrderedVector<int> mapped(fileName);
+    const std::chrono::duration<double, std::milli> openTime = Clock::now() - start;
+    std::cout << "Opening the mapped table with " << mapped.size() << " elements took "
+              << openTime.count() << " ms\n";
+
+    // Query it: The same keys as above are found again
+    std::default_random_engine e2;
+    unsigned int nFound = 0;
+    start = Clock::now();
+    for (unsigned int i = 0; i < 1000000; ++i) {
+        nFound += mapped.contains(d(e2));
+    }
+    const std::chrono::duration<double, std::milli> queryTime = Clock::now() - start;
+    std::cout << "1000000 lookups took " << queryTime.count() << " ms, found " << nFound << '\n';
+
+    return nFound == 1000000 ? 0 : 1;
+}
@@ -0,0 +1,68 @@
+#include "OrderedVector.sol.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/*
+ * Compare OrderedVector::lowerBound, which uses simdLowerBound for arithmetic types,
+ * with std::lower_bound. We first check that both give identical results, and then
+ * measure the time per search.
+ */
+
+constexpr unsigned int nElements = 1 << 20;
+constexpr unsigned int nQueries = 1 << 22;
+
+template<typename T>
+void compare(const char* name) {
+    // Ascending values are appended at the end, so filling is cheap.
+    // Every value is added twice to test duplicates.
+    OrderedVector<T> ov(2 * nElements);
+    std::vector<T> reference;
+    for (unsigned int i = 0; i < nElements; ++i) {
+        const T value = static_cast<T>(3 * i);
+        ov.add(value);
+        ov.add(value);
+        reference.push_back(value);
+        reference.push_back(value);
+    }
+
+    std::default_random_engine e;
+    std::uniform_int_distribution<unsigned int> d{0, 3 * nElements + 10};
+    std::vector<T> queries(nQueries);
+    for (auto& q : queries) q = static_cast<T>(d(e));
+
+    // Check
+    for (auto q : queries) {
+        const auto expected = std::lower_bound(reference.begin(), reference.end(), q) - reference.begin();
+        if (ov.lowerBound(q) != expected) {
+            std::cerr << name << ": wrong result for " << q << '\n';
+            return;
+        }
+    }
+
+    // Measure
+    auto time = [&](auto&& search) {
+        const auto start = std::chrono::steady_clock::now();
+        std::size_t sum = 0;
+        for (auto q : queries) sum += search(q);
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        if (sum == 0) std::cerr << "Unexpected\n";
+        return elapsed.count() / nQueries;
+    };
+    const double generic = time([&](T q){
+        return std::lower_bound(reference.begin(), reference.end(), q) - reference.begin();
+    });
+    const double simd = time([&](T q){ return ov.lowerBound(q); });
+
+    std::cout << name << ":\tstd::lower_bound " << generic << " ns\tOrderedVector::lowerBound "
+              << simd << " ns\n";
+}
+
+int main() {
+    compare<int>("int");
+    compare<float>("float");
+    compare<double>("double");
+    compare<long long>("long long");
+}
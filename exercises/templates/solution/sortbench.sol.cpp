@@ -0,0 +1,61 @@
+#include "OrderedVector.sol.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Build OrderedVectors from unsorted data with the parallel bulk constructor, and compare
+ * with std::sort on a single thread. The number of elements can be given as argument, e.g.
+ * ./sortbench.sol 100000000
+ */
+
+template<typename T, typename Compare=std::less<>>
+void compare(const char* name, const std::vector<T>& input) {
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    std::vector<T> reference = input;
+    std::sort(reference.begin(), reference.end(), Compare{});
+    const std::chrono::duration<double> serial = Clock::now() - start;
+
+    start = Clock::now();
+    OrderedVector<T, Compare> ov(input);
+    const std::chrono::duration<double> parallel = Clock::now() - start;
+
+    // The comparator is a strict weak ordering, so equal elements can be in any order.
+    // Check that the results are sorted and contain the same elements.
+    const bool sorted = std::is_sorted(ov.begin(), ov.end(), Compare{});
+    const bool equal = std::equal(ov.begin(), ov.end(), reference.begin(), reference.end(),
+        [](const T& a, const T& b){ return !Compare{}(a, b) && !Compare{}(b, a); });
+
+    std::cout << name << ":\tstd::sort " << serial.count() << " s\tOrderedVector "
+              << parallel.count() << " s\t" << (sorted && equal ? "OK" : "WRONG") << '\n';
+}
+
+int main(int argc, char* argv[]) {
+    const std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    std::cout << "Sorting " << n << " elements with " << std::thread::hardware_concurrency()
+              << " threads\n";
+
+    std::default_random_engine e;
+    std::vector<int> ints(n);
+    std::uniform_int_distribution<int> di;
+    for (auto& i : ints) i = di(e) - di(e);
+
+    std::vector<float> floats(n);
+    std::normal_distribution<float> df;
+    for (auto& f : floats) f = df(e);
+
+    std::vector<std::string> strings(std::min<std::size_t>(n, 1000000));
+    for (auto& s : strings) s = std::to_string(di(e));
+
+    compare<int>("int (radix)", ints);
+    compare<float>("float (radix)", floats);
+    compare<int, std::greater<>>("int, descending (merge)", ints);
+    compare<std::string>("string (merge)", strings);
+}